@@ -11,6 +11,23 @@
  */
 typedef struct allocator {
     void* (*reallocate_fn)(struct allocator* allocator, void* memory, size_t size);
+    /**
+     * Reallocates memory on an alignment stricter than the one of `reallocate_fn`, or `NULL` if the allocator has no
+     * native support for it.
+     */
+    void* (*reallocate_aligned_fn)(struct allocator* allocator, void* memory, size_t size, size_t alignment);
+    /**
+     * Deallocates memory whose size is known by the caller, or `NULL` if the allocator has no use for the size.
+     */
+    void (*deallocate_sized_fn)(struct allocator* allocator, void* memory, size_t size);
+    /**
+     * Allocates many blocks of the same size at once, or `NULL` if the allocator has no faster way than a loop.
+     */
+    size_t (*allocate_batch_fn)(struct allocator* allocator, size_t size, size_t count, void** memories);
+    /**
+     * Deallocates many blocks at once, or `NULL` if the allocator has no faster way than a loop.
+     */
+    void (*deallocate_batch_fn)(struct allocator* allocator, void** memories, size_t count);
 } allocator_t;
 
 /**
@@ -28,6 +45,34 @@ void* allocate(allocator_t* allocator, size_t size);
  */
 void deallocate(allocator_t* allocator, void* memory);
 
+/**
+ * Using the given allocator, deallocates a block of previously allocated memory of a known size, sparing the allocator
+ * from recovering the size from its metadata.
+ * @param allocator An allocator
+ * @param memory A pointer to memory
+ * @param size The size in bytes requested when the memory was last allocated or reallocated
+ */
+void deallocate_sized(allocator_t* allocator, void* memory, size_t size);
+
+/**
+ * Using the given allocator, allocates `count` blocks of `size` bytes of memory, stopping at the first failure.
+ * @param allocator An allocator
+ * @param size A size in bytes
+ * @param count The number of blocks to allocate
+ * @param memories An array receiving at least `count` pointers
+ * @return The number of blocks allocated, whose pointers are at the beginning of `memories`
+ */
+size_t allocate_batch(allocator_t* allocator, size_t size, size_t count, void** memories);
+
+/**
+ * Using the given allocator, deallocates `count` blocks of previously allocated memory.  `NULL` pointers are ignored.
+ * The pointers may be reordered in `memories`.
+ * @param allocator An allocator
+ * @param memories An array of pointers to memory
+ * @param count The number of pointers
+ */
+void deallocate_batch(allocator_t* allocator, void** memories, size_t count);
+
 /**
  * Using the given allocator, reallocates a block of previously allocated memory to be of the new given size in bytes.
  * If the memory is NULL, an allocation is performed.  If the size is 0, the memory is deallocated.
@@ -38,6 +83,31 @@ void deallocate(allocator_t* allocator, void* memory);
  */
 void* reallocate(allocator_t* allocator, void* memory, size_t size);
 
+/**
+ * Using the given allocator, allocates a block of `size` bytes of memory whose address is a multiple of `alignment`.
+ * The memory is deallocated with `deallocate/2` like any other block.
+ * @param allocator An allocator
+ * @param size A size in bytes
+ * @param alignment A power of two
+ * @return A pointer, or `NULL` if the allocation failed or if the allocator cannot provide this alignment
+ */
+void* allocate_aligned(allocator_t* allocator, size_t size, size_t alignment);
+
+/**
+ * Using the given allocator, reallocates a block of previously allocated memory to be of the new given size in bytes,
+ * with an address that is a multiple of `alignment`.  If the memory is NULL, an allocation is performed.  If the size
+ * is 0, the memory is deallocated.
+ *
+ * Allocators without native support for alignment are assumed to align memory for any fundamental type, so stricter
+ * alignments fail on them.  On failure, the memory is left untouched.
+ * @param allocator An allocator
+ * @param memory A pointer to memory
+ * @param size A size in bytes
+ * @param alignment A power of two
+ * @return The reallocated memory
+ */
+void* reallocate_aligned(allocator_t* allocator, void* memory, size_t size, size_t alignment);
+
 /**
  * Using the given allocator, creates new block of memory with at least enough bytes to hold the given type in memory.
  * @param _allocator An allocator
@@ -47,6 +117,16 @@ void* reallocate(allocator_t* allocator, void* memory, size_t size);
 #define create(_allocator, _Type) \
     ((_Type*) allocate((_allocator), sizeof(_Type)))
 
+/**
+ * Using the given allocator, creates a new block of memory with at least enough bytes to hold the given type in memory,
+ * honoring the alignment of the type even when it is stricter than the one of the allocator.
+ * @param _allocator An allocator
+ * @param _Type The type
+ * @return A pointer to memory
+ */
+#define create_aligned(_allocator, _Type) \
+    ((_Type*) allocate_aligned((_allocator), sizeof(_Type), _Alignof(_Type)))
+
 /**
  * Using the given allocator, creates a new block of memory with at least enough bytes to hold a specified amount of
  * the given type.
@@ -75,4 +155,23 @@ void* reallocate(allocator_t* allocator, void* memory, size_t size);
 #define destroy_array(_allocator, _memory) \
     deallocate((_allocator), (void*) (_memory))
 
+/**
+ * Using the given allocator, destroys a pointer to memory previously allocated with the given allocator using
+ * `create/2`, passing the size of the pointed type along.
+ * @param _allocator An allocator
+ * @param _memory A typed pointer to memory
+ */
+#define destroy_sized(_allocator, _memory) \
+    deallocate_sized((_allocator), (void*) (_memory), sizeof(*(_memory)))
+
+/**
+ * Using the given allocator, destroys a pointer to memory previously allocated with the given allocator using
+ * `create_array/3`, passing the size of the array along.
+ * @param _allocator An allocator
+ * @param _memory A typed pointer to memory
+ * @param _size The number of elements of the array
+ */
+#define destroy_array_sized(_allocator, _memory, _size) \
+    deallocate_sized((_allocator), (void*) (_memory), sizeof(*(_memory)) * (_size))
+
 #endif
@@ -0,0 +1,93 @@
+#ifndef __ALLOCATORS__ARENA_ALLOCATOR__
+#define __ALLOCATORS__ARENA_ALLOCATOR__
+
+#include "allocators/allocator.h"
+
+/**
+ * A chunk of memory obtained from the parent allocator of an arena.
+ */
+typedef struct arena_chunk arena_chunk_t;
+
+/**
+ * An allocator handing out memory by bumping a pointer through chunks obtained from a parent allocator.  Memory is
+ * reclaimed all at once, by resetting the arena entirely or back to a mark.  Only the last allocation can be freed or
+ * resized in place.
+ */
+typedef struct {
+    allocator_t allocator;
+    /**
+     * The allocator providing the chunks.
+     */
+    allocator_t* parent;
+    /**
+     * The smallest size of the memory of a chunk.
+     */
+    size_t chunk_size;
+    /**
+     * The first chunk, or `NULL` if none was allocated yet.
+     */
+    arena_chunk_t* first;
+    /**
+     * The chunk in which memory is bumped.  Chunks following it are kept for reuse after a reset.
+     */
+    arena_chunk_t* current;
+    /**
+     * The next free byte in the current chunk.
+     */
+    char* position;
+    /**
+     * The end of the current chunk.
+     */
+    char* end;
+    /**
+     * The last allocation, or `NULL` if it was freed or if the arena was reset.
+     */
+    char* last;
+} arena_allocator_t;
+
+/**
+ * A position in an arena, to which it can be reset.
+ *
+ * All fields of a mark are considered private.
+ */
+typedef struct {
+    arena_chunk_t* chunk;
+    char* position;
+} arena_mark_t;
+
+/**
+ * Initializes an arena allocator.  No memory is requested from the parent allocator until the first allocation.
+ * @param parent The allocator providing the chunks
+ * @param chunk_size The smallest size in bytes of the memory of a chunk
+ * @return An arena allocator
+ */
+arena_allocator_t arena_allocator_init(allocator_t* parent, size_t chunk_size);
+
+/**
+ * Gives all the chunks of an arena back to its parent allocator.  The arena can still be used afterward.
+ * @param allocator An arena allocator
+ */
+void arena_allocator_deinit(arena_allocator_t* allocator);
+
+/**
+ * Returns the current position of an arena.
+ * @param allocator An arena allocator
+ * @return A mark
+ */
+arena_mark_t arena_mark(arena_allocator_t* allocator);
+
+/**
+ * Frees all the memory allocated since a mark was taken, in constant time.  Marks taken after this one, or before an
+ * earlier reset, must not be used anymore.
+ * @param allocator An arena allocator
+ * @param mark A mark returned by `arena_mark/1`
+ */
+void arena_reset_to_mark(arena_allocator_t* allocator, arena_mark_t mark);
+
+/**
+ * Frees all the memory of an arena in constant time.  The chunks are kept to serve the next allocations.
+ * @param allocator An arena allocator
+ */
+void arena_reset(arena_allocator_t* allocator);
+
+#endif
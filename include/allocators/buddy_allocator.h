@@ -0,0 +1,98 @@
+#ifndef __ALLOCATORS__BUDDY_ALLOCATOR__
+#define __ALLOCATORS__BUDDY_ALLOCATOR__
+
+#include "allocators/allocator.h"
+
+#include <stdint.h>
+
+/**
+ * The base 2 logarithm of the size of the smallest block, which must hold the links of a free list.
+ */
+#define BUDDY_MIN_ORDER 4
+
+/**
+ * The number of orders for which a free list is kept.
+ */
+#define BUDDY_ORDER_COUNT (sizeof(size_t) * 8)
+
+/**
+ * A free block, linked in the free list of its order through its own memory.
+ */
+typedef struct buddy_block buddy_block_t;
+
+/**
+ * A binary buddy allocator over a buffer.  Blocks are powers of two carrying no header: the state of the blocks is
+ * kept in two bitmaps at the beginning of the buffer, over the nodes of a complete binary tree of blocks.  Allocating,
+ * freeing and coalescing take a time logarithmic in the size of the buffer.
+ */
+typedef struct {
+    allocator_t allocator;
+    void* buffer;
+    size_t size;
+    /**
+     * The beginning of the memory divided in blocks, following the bitmaps.
+     */
+    char* region;
+    /**
+     * The size of the memory divided in blocks.  The part of the root block past it is never free.
+     */
+    size_t region_size;
+    /**
+     * The base 2 logarithm of the size of the root block.
+     */
+    unsigned top_order;
+    /**
+     * One bit per node of the tree, set if the block is in a free list.
+     */
+    uint32_t* free_bitmap;
+    /**
+     * One bit per node of the tree, set if the block is divided in two smaller blocks.
+     */
+    uint32_t* split_bitmap;
+    /**
+     * The free blocks of every order.
+     */
+    buddy_block_t* free_lists[BUDDY_ORDER_COUNT];
+} buddy_allocator_t;
+
+/**
+ * Initializes a buddy allocator.  Part of the buffer holds the bitmaps, and the rest is divided in blocks.
+ * @param buffer A buffer aligned for any fundamental type
+ * @param size The size of the buffer in bytes
+ * @return A buddy allocator
+ */
+buddy_allocator_t buddy_allocator_init(void* buffer, size_t size);
+
+/**
+ * Returns the number of free blocks, counted in the bitmap.  This is a count, unlike `nbloclibre/0` of libmem, whose
+ * counterpart is `buddy_allocator_free_size/1`.
+ * @param allocator A buddy allocator
+ * @return A number of blocks
+ */
+size_t buddy_allocator_free_blocks(buddy_allocator_t* allocator);
+
+/**
+ * Returns the number of free bytes, counted in the bitmap, as `nbloclibre/0` of libmem does for its fixed buffer
+ * allocator.
+ * @param allocator A buddy allocator
+ * @return A size in bytes
+ */
+size_t buddy_allocator_free_size(buddy_allocator_t* allocator);
+
+/**
+ * Returns the size of the largest free block, found in the bitmap, as `mem_pgrand_libre/0` of libmem does.
+ * @param allocator A buddy allocator
+ * @return A size in bytes, or 0 if no block is free
+ */
+size_t buddy_allocator_largest_free(buddy_allocator_t* allocator);
+
+/**
+ * Returns the number of free blocks smaller than or equal to a threshold, counted in the bitmap, as `mem_small_free/1`
+ * of libmem does.
+ * @param allocator A buddy allocator
+ * @param threshold A size in bytes
+ * @return A number of blocks
+ */
+size_t buddy_allocator_small_free(buddy_allocator_t* allocator, size_t threshold);
+
+#endif
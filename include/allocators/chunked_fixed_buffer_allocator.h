@@ -0,0 +1,97 @@
+#ifndef __ALLOCATORS__CHUNKED_FIXED_BUFFER_ALLOCATOR__
+#define __ALLOCATORS__CHUNKED_FIXED_BUFFER_ALLOCATOR__
+
+#include "allocators/allocator.h"
+#include "allocators/fixed_buffer_allocator.h"
+
+/**
+ * A chunk of memory obtained from the parent allocator of a chunked fixed buffer allocator, managed by its own fixed
+ * buffer allocator.  The chunk is stored at the beginning of its memory, followed by the buffer of its heap.
+ */
+typedef struct chunked_fixed_buffer_chunk {
+    /**
+     * The chunk searched after this one, or `NULL` for the last one.
+     */
+    struct chunked_fixed_buffer_chunk* next;
+    /**
+     * The chunk searched before this one, or `NULL` for the first one.
+     */
+    struct chunked_fixed_buffer_chunk* previous;
+    /**
+     * The size in bytes of the memory obtained from the parent allocator, chunk included.
+     */
+    size_t size;
+    /**
+     * The number of blocks allocated from the chunk.
+     */
+    size_t live;
+    fixed_buffer_allocator_t heap;
+} chunked_fixed_buffer_chunk_t;
+
+/**
+ * A fixed buffer allocator that grows by obtaining chunks from a parent allocator when no hole of its chunks fits.
+ *
+ * Chunks are searched from the one that last served an allocation, which is moved to the front, so that allocations keep
+ * hitting the same warm chunk until it is full.  Chunks left without any block are given back to the parent allocator
+ * as long as the chunks held add up to more than the high-water mark.
+ */
+typedef struct {
+    allocator_t allocator;
+    /**
+     * The allocator providing the chunks.
+     */
+    allocator_t* parent;
+    /**
+     * The strategy of the heap of every chunk.
+     */
+    fixed_buffer_strategy_t* strategy;
+    /**
+     * The smallest size in bytes of a chunk, larger allocations getting a chunk of their own.
+     */
+    size_t chunk_size;
+    /**
+     * The size in bytes of the chunks kept even when they are empty.
+     */
+    size_t high_water;
+    /**
+     * The chunks, the most recently used first, or `NULL` if none was allocated yet.
+     */
+    chunked_fixed_buffer_chunk_t* chunks;
+    /**
+     * The size in bytes of all chunks.
+     */
+    size_t size;
+} chunked_fixed_buffer_allocator_t;
+
+/**
+ * Initializes a chunked fixed buffer allocator.  No memory is requested from the parent allocator until the first
+ * allocation.
+ * @param strategy The strategy of every chunk, or `NULL` for first fit
+ * @param parent The allocator providing the chunks
+ * @param chunk_size The smallest size in bytes of a chunk
+ * @param high_water The size in bytes of the chunks kept even when they are empty, 0 giving back every empty chunk
+ * @return A chunked fixed buffer allocator
+ */
+chunked_fixed_buffer_allocator_t chunked_fixed_buffer_allocator_init(
+    fixed_buffer_strategy_t* strategy,
+    allocator_t* parent,
+    size_t chunk_size,
+    size_t high_water
+);
+
+/**
+ * Gives all the chunks back to the parent allocator, freeing all of their blocks at once.  The allocator can still be
+ * used afterward.
+ * @param allocator A chunked fixed buffer allocator
+ */
+void chunked_fixed_buffer_allocator_deinit(chunked_fixed_buffer_allocator_t* allocator);
+
+/**
+ * Finds the chunk owning a pointer, whose heap can then be given to `fixed_buffer_node_find/2`.
+ * @param allocator A chunked fixed buffer allocator
+ * @param memory A pointer
+ * @return A chunk, or `NULL` if the memory is not in the buffer of a chunk
+ */
+chunked_fixed_buffer_chunk_t* chunked_fixed_buffer_chunk_find(chunked_fixed_buffer_allocator_t* allocator, void* memory);
+
+#endif
@@ -0,0 +1,184 @@
+#ifndef __ALLOCATORS__CONCURRENT_FIXED_BUFFER_ALLOCATOR__
+#define __ALLOCATORS__CONCURRENT_FIXED_BUFFER_ALLOCATOR__
+
+#include "allocators/allocator.h"
+#include "allocators/fixed_buffer_allocator.h"
+
+#include <stdatomic.h>
+#include <threads.h>
+
+/**
+ * The size assumed for cache lines, which shards are aligned on so that their locks are not falsely shared.
+ */
+#define CONCURRENT_FIXED_BUFFER_CACHE_LINE 64
+
+/**
+ * The largest number of remotely freed blocks given back to the heap of a shard at once.
+ */
+#define CONCURRENT_FIXED_BUFFER_DRAIN_BATCH 64
+
+/**
+ * The ways of choosing the home shard of a thread.
+ */
+typedef enum {
+    /**
+     * Threads are spread over the shards in the order in which they first allocate.
+     */
+    CFBR_THREAD,
+    /**
+     * Threads use the shard of the CPU they run on, so that threads sharing a CPU share a shard.  Falls back to
+     * `CFBR_THREAD` where the current CPU cannot be queried.
+     */
+    CFBR_CPU,
+} concurrent_fixed_buffer_routing_t;
+
+/**
+ * Counters of a shard, updated under its lock.
+ */
+typedef struct {
+    /**
+     * The number of blocks allocated from the shard.
+     */
+    size_t allocations;
+    /**
+     * The number of blocks allocated from the shard for threads whose home is another shard that ran dry.
+     */
+    size_t steals;
+    /**
+     * The number of allocations the shard could not serve.
+     */
+    size_t failures;
+    /**
+     * The number of blocks freed by threads whose home is the shard.
+     */
+    size_t local_frees;
+    /**
+     * The number of blocks freed by threads whose home is another shard, counted when they are given back to the heap.
+     */
+    size_t remote_frees;
+} concurrent_fixed_buffer_stats_t;
+
+/**
+ * A block freed by a thread whose home shard is not the one owning it, waiting to be given back to the heap.
+ */
+typedef struct concurrent_fixed_buffer_remote concurrent_fixed_buffer_remote_t;
+
+/**
+ * A part of the buffer of a concurrent fixed buffer allocator, managed by its own fixed buffer allocator behind its own
+ * lock.
+ */
+typedef struct {
+    _Alignas(CONCURRENT_FIXED_BUFFER_CACHE_LINE) mtx_t lock;
+    fixed_buffer_allocator_t heap;
+    concurrent_fixed_buffer_stats_t stats;
+    /**
+     * The blocks freed by threads whose home is another shard while the lock was held, pushed without the lock and given
+     * back to the heap in batches by the next thread locking the shard.  It has its own cache line, since those threads write it
+     * concurrently with the holder of the lock.
+     */
+    _Alignas(CONCURRENT_FIXED_BUFFER_CACHE_LINE) _Atomic(concurrent_fixed_buffer_remote_t*) remote;
+} concurrent_fixed_buffer_shard_t;
+
+/**
+ * A fixed buffer allocator that can be used from many threads at once.
+ *
+ * The buffer is split in shards, each one being a fixed buffer allocator with its own lock.  Every thread allocates from
+ * a home shard, chosen by thread or by CPU, and steals from the other shards when it is exhausted, after which it
+ * allocates first from the shard it stole from so that threads move away from shards running dry.  Memory is freed in
+ * the shard owning it, found from its address: directly if it is the home shard of the freeing thread or if the lock of
+ * the shard is free, and otherwise through the lock-free queue of remote frees of the shard, so that threads freeing
+ * memory allocated elsewhere never wait for the lock of another shard.  Blocks are only queued if their own header is
+ * that of a live block, since neighboring headers cannot be read without the lock, and a block freed twice while queued
+ * is ignored.
+ */
+typedef struct {
+    allocator_t allocator;
+    void* buffer;
+    size_t size;
+    /**
+     * The shards, stored at the beginning of the buffer.
+     */
+    concurrent_fixed_buffer_shard_t* shards;
+    size_t shard_count;
+    concurrent_fixed_buffer_routing_t routing;
+    /**
+     * The beginning of the memory of the first shard, the others following it.
+     */
+    char* region;
+    /**
+     * The size of the memory of every shard.
+     */
+    size_t shard_size;
+} concurrent_fixed_buffer_allocator_t;
+
+/**
+ * Initializes a concurrent fixed buffer allocator.
+ * @param strategy The strategy of every shard, or `NULL` for first fit
+ * @param shard_count The number of shards, typically the number of threads using the allocator
+ * @param buffer A buffer aligned on 8 bytes
+ * @param size The size of the buffer in bytes
+ * @return A concurrent fixed buffer allocator, with no shards if the buffer is too small or if a lock could not be
+ * created
+ */
+concurrent_fixed_buffer_allocator_t concurrent_fixed_buffer_allocator_init(
+    fixed_buffer_strategy_t* strategy,
+    size_t shard_count,
+    void* buffer,
+    size_t size
+);
+
+/**
+ * Initializes a concurrent fixed buffer allocator choosing the home shard of threads in the given way.
+ * @param strategy The strategy of every shard, or `NULL` for first fit
+ * @param routing The way of choosing the home shard of a thread
+ * @param shard_count The number of shards, typically the number of threads or CPUs using the allocator
+ * @param buffer A buffer aligned on 8 bytes
+ * @param size The size of the buffer in bytes
+ * @return A concurrent fixed buffer allocator, with no shards if the buffer is too small or if a lock could not be
+ * created
+ */
+concurrent_fixed_buffer_allocator_t concurrent_fixed_buffer_allocator_init_with_routing(
+    fixed_buffer_strategy_t* strategy,
+    concurrent_fixed_buffer_routing_t routing,
+    size_t shard_count,
+    void* buffer,
+    size_t size
+);
+
+/**
+ * Gives the blocks waiting in the queues of remote frees of all shards back to their heaps, which threads otherwise only
+ * do for the shards they use.
+ * @param allocator A concurrent fixed buffer allocator
+ */
+void concurrent_fixed_buffer_allocator_drain(concurrent_fixed_buffer_allocator_t* allocator);
+
+/**
+ * Drains the queues of remote frees and destroys the locks of a concurrent fixed buffer allocator.  It must not be used
+ * by any thread anymore.
+ * @param allocator A concurrent fixed buffer allocator
+ */
+void concurrent_fixed_buffer_allocator_deinit(concurrent_fixed_buffer_allocator_t* allocator);
+
+/**
+ * Returns the shard owning a pointer.
+ * @param allocator A concurrent fixed buffer allocator
+ * @param memory A pointer
+ * @return A shard, or `NULL` if the memory is not in the buffer of a shard
+ */
+concurrent_fixed_buffer_shard_t* concurrent_fixed_buffer_shard_find(
+    concurrent_fixed_buffer_allocator_t* allocator,
+    void* memory
+);
+
+/**
+ * Returns the counters of a shard.
+ * @param allocator A concurrent fixed buffer allocator
+ * @param index The index of a shard, less than the number of shards
+ * @return Counters
+ */
+concurrent_fixed_buffer_stats_t concurrent_fixed_buffer_shard_stats(
+    concurrent_fixed_buffer_allocator_t* allocator,
+    size_t index
+);
+
+#endif
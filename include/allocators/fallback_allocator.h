@@ -0,0 +1,76 @@
+#ifndef __ALLOCATORS__FALLBACK_ALLOCATOR__
+#define __ALLOCATORS__FALLBACK_ALLOCATOR__
+
+#include "allocators/allocator.h"
+
+/**
+ * Returns the size of a block of the primary allocator of a fallback allocator, checking that it is one.
+ * @param primary The primary allocator
+ * @param memory A pointer into the memory of the primary allocator
+ * @return The size of the block in bytes, or 0 if the pointer is not a block currently allocated
+ */
+typedef size_t (*fallback_size_fn_t)(allocator_t* primary, void* memory);
+
+/**
+ * An allocator trying a primary allocator first, such as a fixed buffer allocator over a stack buffer, and falling back
+ * to a secondary allocator when it fails, such as the C allocator.
+ *
+ * The primary allocator hands out memory from a single range, so that the owner of a block is found by comparing its
+ * address with that range.  Blocks of the primary allocator that cannot grow because it is full move to the secondary
+ * allocator, and blocks of the secondary allocator stay there.  Moving a block copies the size reported for it by a
+ * function of the primary allocator, which also tells a block the primary allocator failed to grow apart from a pointer
+ * it does not know.
+ */
+typedef struct {
+    allocator_t allocator;
+    allocator_t* primary;
+    allocator_t* secondary;
+    /**
+     * Returns the size of the blocks of the primary allocator.
+     */
+    fallback_size_fn_t size_fn;
+    /**
+     * The beginning of the memory of the primary allocator.
+     */
+    char* begin;
+    /**
+     * The end of the memory of the primary allocator.
+     */
+    char* end;
+} fallback_allocator_t;
+
+/**
+ * Initializes a fallback allocator.
+ * @param primary The allocator tried first
+ * @param buffer The beginning of the memory from which the primary allocator allocates, such as its buffer
+ * @param size The size in bytes of that memory
+ * @param size_fn Returns the size of the blocks of the primary allocator, such as `fallback_fixed_buffer_size/2`
+ * @param secondary The allocator used when the primary allocator fails
+ * @return A fallback allocator
+ */
+fallback_allocator_t fallback_allocator_init(
+    allocator_t* primary,
+    void* buffer,
+    size_t size,
+    fallback_size_fn_t size_fn,
+    allocator_t* secondary
+);
+
+/**
+ * Returns the size of a block of a fixed buffer allocator, the size function of a fallback allocator whose primary
+ * allocator is a fixed buffer allocator.  The allocator is not locked.
+ * @param primary The `allocator` field of a fixed buffer allocator
+ * @param memory A pointer into its buffer
+ * @return The size of the block in bytes, or 0 if the pointer is not a block currently allocated
+ */
+size_t fallback_fixed_buffer_size(allocator_t* primary, void* memory);
+
+/**
+ * Checks if a block comes from the primary allocator of a fallback allocator.
+ * @param allocator A fallback allocator
+ * @param memory A block of the allocator
+ * @return If the block belongs to the primary allocator
+ */
+bool fallback_allocator_owns_primary(fallback_allocator_t* allocator, void* memory);
+
+#endif
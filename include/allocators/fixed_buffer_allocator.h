@@ -3,6 +3,7 @@
 
 #include "allocators/allocator.h"
 
+#include <stdint.h>
 #include <stdio.h>
 
 typedef struct fixed_buffer_strategy fixed_buffer_strategy_t;
@@ -10,49 +11,197 @@ extern fixed_buffer_strategy_t* FBS_FIRST_FIT;
 extern fixed_buffer_strategy_t* FBS_BEST_FIT;
 extern fixed_buffer_strategy_t* FBS_WORST_FIT;
 extern fixed_buffer_strategy_t* FBS_NEXT_FIT;
+/**
+ * A two-level segregated fit strategy, allocating and freeing in constant time with a good fit.
+ */
+extern fixed_buffer_strategy_t* FBS_TLSF;
+
+/**
+ * The number of first-level size classes of the two-level segregated fit strategy, each one spanning a power of two.
+ */
+#define FIXED_BUFFER_TLSF_FL_COUNT 32
+
+/**
+ * The base 2 logarithm of the number of second-level size classes in each first-level size class.
+ */
+#define FIXED_BUFFER_TLSF_SL_LOG2 4
+
+/**
+ * The number of second-level size classes in each first-level size class.
+ */
+#define FIXED_BUFFER_TLSF_SL_COUNT (1 << FIXED_BUFFER_TLSF_SL_LOG2)
+
+/**
+ * Describes how node headers are laid out in the buffer of a fixed buffer allocator.
+ */
+typedef struct fixed_buffer_layout fixed_buffer_layout_t;
+
+/**
+ * Node headers holding the hole flag, the size and a pointer to the previous node, taking 24 bytes on 64-bit targets.
+ */
+extern fixed_buffer_layout_t* FBL_STANDARD;
+/**
+ * Node headers packing the size and the flags in 8 bytes.  Holes repeat their size in a footer, so that the following
+ * node can find them without a pointer to its previous node.  The smallest block holds 24 bytes instead of 16.
+ */
+extern fixed_buffer_layout_t* FBL_COMPACT;
 
 /**
  * A node in the allocation list of a fixed buffer allocator.
+ *
+ * The header of a node is laid out according to the layout of its allocator, and must only be accessed through the
+ * `fixed_buffer_node_*` functions.
  */
-typedef struct fixed_buffer_node {
+typedef struct fixed_buffer_node fixed_buffer_node_t;
+
+typedef struct {
+    allocator_t allocator;
+    fixed_buffer_strategy_t* strategy;
+    fixed_buffer_layout_t* layout;
+    void* buffer;
+    size_t size;
     /**
-     * Indicates if this node is a hole.
+     * The size from which holes are given back to the system when they are formed, or 0 if they are never.
      */
-    bool is_hole;
+    size_t decommit_threshold;
     /**
-     * The size of the memory following this node.
+     * The size of the pages given back to the system, or 0 until it is needed.
      */
-    size_t size;
+    size_t page_size;
     /**
-     * A pointer to the previous node in memory.
+     * Indicates if the buffer is mapped shared, in which case its pages are never given back to the system.
      */
-    struct fixed_buffer_node* previous;
-} fixed_buffer_node_t;
-
-typedef struct {
-    allocator_t allocator;
-    void* buffer;
-    size_t size;
-    fixed_buffer_node_t* last_node_reserved;
+    bool shared;
+    /**
+     * The index of holes maintained by the current strategy.  Holes store the links of the index in their own memory.
+     */
+    union {
+        /**
+         * A free list sorted by address, used by the first and next fit strategies.
+         */
+        struct {
+            fixed_buffer_node_t* first;
+            /**
+             * The hole from which the next fit strategy resumes its search.
+             */
+            fixed_buffer_node_t* rover;
+        } list;
+        /**
+         * A tree of holes ordered by size, used by the best and worst fit strategies.
+         */
+        struct {
+            fixed_buffer_node_t* root;
+        } tree;
+        /**
+         * Segregated free lists, used by the two-level segregated fit strategy.
+         */
+        struct {
+            uint32_t fl_bitmap;
+            uint32_t sl_bitmap[FIXED_BUFFER_TLSF_FL_COUNT];
+            fixed_buffer_node_t* heads[FIXED_BUFFER_TLSF_FL_COUNT][FIXED_BUFFER_TLSF_SL_COUNT];
+        } tlsf;
+    } holes;
 } fixed_buffer_allocator_t;
 
 fixed_buffer_allocator_t fixed_buffer_allocator_init(fixed_buffer_strategy_t* strategy, void* buffer, size_t size);
 
+/**
+ * Initializes a fixed buffer allocator whose node headers follow the given layout.
+ * @param strategy A strategy, or `NULL` for first fit
+ * @param layout A layout, or `NULL` for the standard layout
+ * @param buffer A buffer aligned on 8 bytes
+ * @param size The size of the buffer in bytes
+ * @return A fixed buffer allocator
+ */
+fixed_buffer_allocator_t fixed_buffer_allocator_init_with_layout(
+    fixed_buffer_strategy_t* strategy,
+    fixed_buffer_layout_t* layout,
+    void* buffer,
+    size_t size
+);
+
 void fixed_buffer_allocator_set_strategy(fixed_buffer_allocator_t* allocator, fixed_buffer_strategy_t* strategy);
 
+/**
+ * Reattaches a fixed buffer allocator whose state was saved along with its buffer, for instance in a mapped file, and
+ * whose strategy and layout were recorded separately since they point into the running program.  If the buffer is at
+ * the address it had when the state was saved, this takes constant time.  Otherwise every node is visited to rewrite
+ * the pointers of the headers and of the index of holes.
+ * @param allocator The saved state of a fixed buffer allocator
+ * @param strategy The strategy the allocator was using
+ * @param layout The layout the allocator was using
+ * @param buffer The buffer of the allocator, at its current address
+ */
+void fixed_buffer_allocator_reattach(
+    fixed_buffer_allocator_t* allocator,
+    fixed_buffer_strategy_t* strategy,
+    fixed_buffer_layout_t* layout,
+    void* buffer
+);
+
+/**
+ * Makes a fixed buffer allocator give the pages inside holes back to the system, with `madvise(MADV_DONTNEED)`, as soon
+ * as a released block leaves a hole of at least the given size.  Decommitted holes are flagged, so that merging a block
+ * into them only gives back the pages of that block.  The buffer must be private memory, read as zeros once given back.
+ * @param allocator A fixed buffer allocator
+ * @param threshold The size in bytes from which holes are decommitted, or 0 to stop decommitting them
+ */
+void fixed_buffer_allocator_set_decommit(fixed_buffer_allocator_t* allocator, size_t threshold);
+
+/**
+ * Flags the buffer of a fixed buffer allocator as shared memory, such as a `MAP_SHARED` mapping.  Its holes are then
+ * never decommitted, since `madvise(MADV_DONTNEED)` only drops the mapping of shared pages without freeing them, and
+ * does not clear them.
+ * @param allocator A fixed buffer allocator
+ * @param shared Indicates if the buffer is shared memory
+ */
+void fixed_buffer_allocator_set_shared(fixed_buffer_allocator_t* allocator, bool shared);
+
+/**
+ * Gives the pages inside every hole not decommitted yet back to the system, unless the buffer is shared memory.
+ * @param allocator A fixed buffer allocator
+ * @return The number of bytes given back
+ */
+size_t fixed_buffer_allocator_trim(fixed_buffer_allocator_t* allocator);
+
+/**
+ * Returns the size of a node header in a layout.
+ * @param layout A layout
+ * @return A size in bytes
+ */
+size_t fixed_buffer_layout_header_size(fixed_buffer_layout_t* layout);
+
 /**
  * Returns a pointer to the memory associated with this node.
+ * @param allocator A fixed buffer allocator
  * @param node A node
  * @return A pointer
  */
-void* fixed_buffer_node_memory(fixed_buffer_node_t* node);
+void* fixed_buffer_node_memory(fixed_buffer_allocator_t* allocator, fixed_buffer_node_t* node);
 
 /**
  * Returns a pointer to the end of this node and its associated memory.
+ * @param allocator A fixed buffer allocator
  * @param node A node
  * @return A pointer
  */
-void* fixed_buffer_node_end(fixed_buffer_node_t* node);
+void* fixed_buffer_node_end(fixed_buffer_allocator_t* allocator, fixed_buffer_node_t* node);
+
+/**
+ * Returns the size of the memory associated with this node.
+ * @param allocator A fixed buffer allocator
+ * @param node A node
+ * @return A size in bytes
+ */
+size_t fixed_buffer_node_size(fixed_buffer_allocator_t* allocator, fixed_buffer_node_t* node);
+
+/**
+ * Indicates if this node is a hole.
+ * @param allocator A fixed buffer allocator
+ * @param node A node
+ * @return If the node is a hole
+ */
+bool fixed_buffer_node_is_hole(fixed_buffer_allocator_t* allocator, fixed_buffer_node_t* node);
 
 /**
  * Returns the first node from an allocator
@@ -72,15 +221,60 @@ fixed_buffer_node_t* fixed_buffer_node_first(fixed_buffer_allocator_t* allocator
 fixed_buffer_node_t* fixed_buffer_node_next(fixed_buffer_allocator_t* allocator, fixed_buffer_node_t* node);
 
 /**
- * Finds a node for the given memory location.
+ * Returns the first hole from an allocator.
  *
- * If the memory is not managed by this allocator, `NULL` is returned.
+ * Holes are kept in an index maintained by the strategy, so that strategies only have to search holes.  The order in
+ * which holes are returned depends on the strategy.
+ * @param allocator A fixed buffer allocator
+ * @return A hole, or `NULL` if the allocator is full
+ */
+fixed_buffer_node_t* fixed_buffer_hole_first(fixed_buffer_allocator_t* allocator);
+
+/**
+ * Returns the hole following another hole in the index of an allocator.
+ * @param allocator A fixed buffer allocator
+ * @param node A hole
+ * @return The following hole, or `NULL`
+ */
+fixed_buffer_node_t* fixed_buffer_hole_next(fixed_buffer_allocator_t* allocator, fixed_buffer_node_t* node);
+
+/**
+ * Returns the largest hole from an allocator.
+ * @param allocator A fixed buffer allocator
+ * @return A hole, or `NULL` if the allocator is full
+ */
+fixed_buffer_node_t* fixed_buffer_hole_largest(fixed_buffer_allocator_t* allocator);
+
+/**
+ * Finds a node for the given memory location in constant time.
+ *
+ * The node header is read directly in front of the memory and validated by checking that it lies in the buffer, that
+ * it carries a live tag, that it is linked to its neighboring nodes and that it is not a hole.  If the memory is not a
+ * block currently allocated by this allocator, `NULL` is returned.
  * @param allocator A fixed buffer allocator
  * @param memory A pointer
  * @return A node
  */
 fixed_buffer_node_t* fixed_buffer_node_find(fixed_buffer_allocator_t* allocator, void* memory);
 
+/**
+ * Finds a node for the given memory location from its own header only, checking that it lies in the buffer, that it
+ * carries a live tag and that it is not a hole.  Unlike `fixed_buffer_node_find/2`, neighboring nodes are not read, so
+ * the check does not depend on headers that the holder of a lock may be rewriting, such as those of blocks merging into
+ * a hole, whose tags are cleared.
+ * @param allocator A fixed buffer allocator
+ * @param memory A pointer
+ * @return A node, or `NULL` if the memory is not a live block
+ */
+fixed_buffer_node_t* fixed_buffer_node_peek(fixed_buffer_allocator_t* allocator, void* memory);
+
+/**
+ * Returns the number of bytes of the buffer taken by node headers, to measure the memory overhead of a layout.
+ * @param allocator A fixed buffer allocator
+ * @return A size in bytes
+ */
+size_t fixed_buffer_allocator_overhead(fixed_buffer_allocator_t* allocator);
+
 /**
  * Prints debug information associated with a fixed buffer allocator.
  * @param allocator An allocator
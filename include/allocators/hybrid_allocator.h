@@ -0,0 +1,49 @@
+#ifndef __ALLOCATORS__HYBRID_ALLOCATOR__
+#define __ALLOCATORS__HYBRID_ALLOCATOR__
+
+#include "allocators/allocator.h"
+#include "allocators/page_allocator.h"
+
+/**
+ * An allocator sending allocations larger than a threshold to their own page mappings, and the others to an inner
+ * allocator, so that large buffers neither fragment the inner allocator nor get copied when they grow: the pages of a
+ * large block are moved by the kernel with `mremap` where available.
+ *
+ * Every block is preceded by a header holding its size and a tag telling which allocator owns it.  Small blocks growing
+ * past the threshold move to their own mapping, while large blocks stay mapped even when shrinking below it.  Small
+ * blocks can be aligned up to the size of the header, and large blocks up to a page.
+ */
+typedef struct {
+    allocator_t allocator;
+    /**
+     * The allocator of small blocks.
+     */
+    allocator_t* inner;
+    /**
+     * The allocator of large blocks.
+     */
+    page_allocator_t pages;
+    /**
+     * The size in bytes above which blocks get their own mapping.
+     */
+    size_t threshold;
+} hybrid_allocator_t;
+
+/**
+ * Initializes a hybrid allocator.
+ * @param inner The allocator of small blocks
+ * @param flags A combination of `page_flags_t` for the mappings of large blocks, or 0
+ * @param threshold The size in bytes above which blocks get their own mapping
+ * @return A hybrid allocator
+ */
+hybrid_allocator_t hybrid_allocator_init(allocator_t* inner, unsigned flags, size_t threshold);
+
+/**
+ * Indicates if a block of a hybrid allocator has its own mapping.
+ * @param allocator A hybrid allocator
+ * @param memory A block of the allocator
+ * @return If the block is large
+ */
+bool hybrid_allocator_is_large(hybrid_allocator_t* allocator, void* memory);
+
+#endif
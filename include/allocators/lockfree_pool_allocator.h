@@ -0,0 +1,63 @@
+#ifndef __ALLOCATORS__LOCKFREE_POOL_ALLOCATOR__
+#define __ALLOCATORS__LOCKFREE_POOL_ALLOCATOR__
+
+#include "allocators/allocator.h"
+
+#include <stdatomic.h>
+#include <stdint.h>
+
+/**
+ * The size assumed for cache lines, which the head of the free list is aligned on so that it is not falsely shared.
+ */
+#define LOCKFREE_POOL_CACHE_LINE 64
+
+/**
+ * An allocator handing out blocks of a single size from a buffer, that any number of threads can allocate from and
+ * free to at once without a lock.
+ *
+ * Free blocks form a stack linked by index, whose head packs the index of the top block with a tag incremented by
+ * every operation, so that a block popped and pushed back between the read and the update of the head by another
+ * thread is noticed (the ABA problem).  Only 2^32 operations completing during that window could go unnoticed.
+ */
+typedef struct {
+    allocator_t allocator;
+    void* buffer;
+    /**
+     * The size of a block, large enough to hold the index of the next free block.
+     */
+    size_t block_size;
+    /**
+     * The number of blocks in the buffer.
+     */
+    uint32_t block_count;
+    /**
+     * The tag in the upper half and the index of the first free block in the lower half, the index being
+     * `block_count` when no block is free.
+     */
+    _Alignas(LOCKFREE_POOL_CACHE_LINE) atomic_uint_least64_t head;
+    /**
+     * Keeps whatever follows the allocator off the cache line of the head.
+     */
+    char padding[LOCKFREE_POOL_CACHE_LINE - sizeof(atomic_uint_least64_t)];
+} lockfree_pool_allocator_t;
+
+/**
+ * Initializes a lock-free pool allocator, all blocks being free.
+ *
+ * Blocks are aligned for any type whose size is `block_size`, provided the buffer is aligned on 8 bytes.
+ * @param buffer A buffer aligned on 8 bytes
+ * @param size The size of the buffer in bytes
+ * @param block_size The size in bytes of every block
+ * @return A lock-free pool allocator, with no blocks if the buffer is too small
+ */
+lockfree_pool_allocator_t lockfree_pool_allocator_init(void* buffer, size_t size, size_t block_size);
+
+/**
+ * Checks if a pointer is a block of a lock-free pool allocator.
+ * @param allocator A lock-free pool allocator
+ * @param memory A pointer
+ * @return If the pointer is the beginning of a block
+ */
+bool lockfree_pool_allocator_owns(lockfree_pool_allocator_t* allocator, void* memory);
+
+#endif
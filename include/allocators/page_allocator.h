@@ -0,0 +1,70 @@
+#ifndef __ALLOCATORS__PAGE_ALLOCATOR__
+#define __ALLOCATORS__PAGE_ALLOCATOR__
+
+#include "allocators/allocator.h"
+
+/**
+ * The size of the header in front of the memory of every mapping, keeping it aligned on a cache line.
+ */
+#define PAGE_HEADER_SIZE 64
+
+/**
+ * The size of the huge pages requested with `PAGE_HUGETLB`, the default on x86-64 and AArch64.
+ */
+#define PAGE_HUGE_SIZE ((size_t) 2 * 1024 * 1024)
+
+/**
+ * Options of a page allocator, to be combined with a bitwise or.
+ */
+typedef enum {
+    /**
+     * Mappings are prefaulted when created or grown, so that first accesses do not fault.
+     */
+    PAGE_POPULATE = 1 << 0,
+    /**
+     * Mappings are advised to be backed by transparent huge pages.
+     */
+    PAGE_TRANSPARENT_HUGE = 1 << 1,
+    /**
+     * Mappings are backed by reserved huge pages, falling back to regular pages when none are available.
+     */
+    PAGE_HUGETLB = 1 << 2,
+} page_flags_t;
+
+/**
+ * An allocator mapping every allocation directly from the operating system, in whole pages.
+ *
+ * Every mapping starts with a header recording its extent, followed by the memory, so that allocations are aligned on
+ * `PAGE_HEADER_SIZE` bytes.  Stricter alignments are obtained by mapping more, up to the alignment itself.  Shrinking
+ * gives whole pages back to the system, and growing within the last page of a mapping happens in place.  Growing further
+ * uses `mremap` where available, which moves page table entries instead of copying the memory.
+ */
+typedef struct {
+    allocator_t allocator;
+    /**
+     * A combination of `page_flags_t`.
+     */
+    unsigned flags;
+    /**
+     * The size of a regular page.
+     */
+    size_t page_size;
+} page_allocator_t;
+
+/**
+ * Initializes a page allocator.
+ * @param flags A combination of `page_flags_t`, or 0
+ * @return A page allocator
+ */
+page_allocator_t page_allocator_init(unsigned flags);
+
+/**
+ * Returns the number of bytes usable from an allocation of a page allocator, which is at least the size requested and
+ * extends to the end of its last page.
+ * @param allocator A page allocator
+ * @param memory An allocation of the allocator
+ * @return A size in bytes
+ */
+size_t page_allocator_capacity(page_allocator_t* allocator, void* memory);
+
+#endif
@@ -0,0 +1,124 @@
+#ifndef __ALLOCATORS__PERSISTENT_ALLOCATOR__
+#define __ALLOCATORS__PERSISTENT_ALLOCATOR__
+
+#include "allocators/allocator.h"
+#include "allocators/fixed_buffer_allocator.h"
+
+/**
+ * The size of the beginning of a persistent heap file holding the state of the allocator, the heap following it.
+ */
+#define PERSISTENT_ROOT_SIZE 8192
+
+/**
+ * The state of a persistent heap, stored at the beginning of its file.
+ */
+typedef struct persistent_root persistent_root_t;
+
+/**
+ * A fixed buffer allocator over a file mapped in memory, so that what is allocated in it survives the program.
+ *
+ * The state of the allocator is stored in the file along with the heap.  The file is mapped back at the address it had
+ * when it was last closed if possible, in which case reopening it takes constant time.  Otherwise the pointers of the
+ * heap are rewritten to the new address, and data stored in the heap must link blocks by offset, as returned by
+ * `persistent_allocator_offset/2`, to stay valid.
+ *
+ * The file is flagged dirty, and the flag written, before the heap is first modified after being opened or
+ * checkpointed, and a checkpoint flags it clean again.  A file still flagged dirty, because its program stopped after
+ * modifying the heap without checkpointing it, is refused when opened.  Writes to the memory of blocks go unnoticed, so
+ * they must be preceded by `persistent_allocator_touch/1` to be covered by the flag.
+ */
+typedef struct {
+    allocator_t allocator;
+    /**
+     * The file descriptor of the heap file.
+     */
+    int file;
+    /**
+     * The beginning of the mapping of the file.
+     */
+    char* base;
+    /**
+     * The size of the file in bytes.
+     */
+    size_t size;
+    /**
+     * The state of the heap, at the beginning of the mapping.
+     */
+    persistent_root_t* root;
+    /**
+     * Indicates if the file could not be mapped at its previous address when it was opened.
+     */
+    bool relocated;
+} persistent_allocator_t;
+
+/**
+ * Opens a persistent heap file, creating it if it does not exist or is empty.
+ * @param allocator A persistent allocator, initialized by this function
+ * @param path The path of the file
+ * @param size The size in bytes of a new file, larger than `PERSISTENT_ROOT_SIZE`, ignored for an existing file
+ * @param strategy The strategy of a new heap, or `NULL` for first fit, ignored for an existing file
+ * @param layout The layout of a new heap, or `NULL` for the standard layout, ignored for an existing file
+ * @return If the file could be opened and mapped, and held a heap that was closed cleanly
+ */
+bool persistent_allocator_open(
+    persistent_allocator_t* allocator,
+    const char* path,
+    size_t size,
+    fixed_buffer_strategy_t* strategy,
+    fixed_buffer_layout_t* layout
+);
+
+/**
+ * Flags the heap dirty and waits for the flag to be written, unless it already is.  Allocations and deallocations do it
+ * themselves, and the data stored in blocks should do it before being written.
+ * @param allocator A persistent allocator
+ * @return If the flag is written
+ */
+bool persistent_allocator_touch(persistent_allocator_t* allocator);
+
+/**
+ * Writes the whole heap to its file flagged clean and waits for it to be written, so that the file can be opened again
+ * until the heap is modified.
+ * @param allocator A persistent allocator
+ * @return If the heap could be written
+ */
+bool persistent_allocator_checkpoint(persistent_allocator_t* allocator);
+
+/**
+ * Checkpoints the heap, leaving it flagged clean, and closes its file.
+ * @param allocator A persistent allocator
+ * @return If the heap could be written
+ */
+bool persistent_allocator_close(persistent_allocator_t* allocator);
+
+/**
+ * Returns the offset of a pointer from the beginning of the file, which stays valid when the file is mapped elsewhere.
+ * @param allocator A persistent allocator
+ * @param memory A pointer into the heap, or `NULL`
+ * @return An offset, or 0 for `NULL`
+ */
+size_t persistent_allocator_offset(persistent_allocator_t* allocator, void* memory);
+
+/**
+ * Returns the pointer at an offset from the beginning of the file.
+ * @param allocator A persistent allocator
+ * @param offset An offset returned by `persistent_allocator_offset/2`, or 0
+ * @return A pointer, or `NULL` for 0
+ */
+void* persistent_allocator_pointer(persistent_allocator_t* allocator, size_t offset);
+
+/**
+ * Returns the block recorded as the entry point of the data of the heap.
+ * @param allocator A persistent allocator
+ * @return A block, or `NULL` if none was recorded
+ */
+void* persistent_allocator_get_root(persistent_allocator_t* allocator);
+
+/**
+ * Records a block as the entry point of the data of the heap, to be found again after the file is reopened.
+ * @param allocator A persistent allocator
+ * @param memory A block, or `NULL`
+ */
+void persistent_allocator_set_root(persistent_allocator_t* allocator, void* memory);
+
+#endif
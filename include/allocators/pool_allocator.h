@@ -0,0 +1,143 @@
+#ifndef __ALLOCATORS__POOL_ALLOCATOR__
+#define __ALLOCATORS__POOL_ALLOCATOR__
+
+#include "allocators/allocator.h"
+
+/**
+ * A slab of blocks obtained from the parent allocator of a pool.
+ */
+typedef struct pool_slab pool_slab_t;
+
+/**
+ * A free block of a pool, linking to the next free block in its own memory.
+ */
+typedef struct pool_block {
+    struct pool_block* next;
+} pool_block_t;
+
+/**
+ * An allocator handing out blocks of a single size from slabs obtained from a parent allocator.  Blocks carry no
+ * header, and both allocation and deallocation take constant time.
+ */
+typedef struct {
+    allocator_t allocator;
+    /**
+     * The allocator providing the slabs.
+     */
+    allocator_t* parent;
+    /**
+     * The size of a block, large enough to link it in the free list.
+     */
+    size_t block_size;
+    /**
+     * The number of blocks in a slab.
+     */
+    size_t slab_count;
+    /**
+     * The first free block, or `NULL` if a slab must be allocated.
+     */
+    pool_block_t* free;
+    /**
+     * The list of slabs, or `NULL` if none was allocated yet.
+     */
+    pool_slab_t* slabs;
+} pool_allocator_t;
+
+/**
+ * Initializes a pool allocator.  No memory is requested from the parent allocator until the first allocation.
+ *
+ * Blocks are aligned for any type whose size is `block_size`.
+ * @param parent The allocator providing the slabs
+ * @param block_size The size in bytes of every block
+ * @param slab_count The number of blocks requested from the parent allocator at once
+ * @return A pool allocator
+ */
+pool_allocator_t pool_allocator_init(allocator_t* parent, size_t block_size, size_t slab_count);
+
+/**
+ * Gives all the slabs of a pool back to its parent allocator, freeing all of its blocks at once.  The pool can still
+ * be used afterward.
+ * @param allocator A pool allocator
+ */
+void pool_allocator_deinit(pool_allocator_t* allocator);
+
+/**
+ * Allocates a slab from the parent allocator and adds its blocks to the free list.
+ * @param allocator A pool allocator
+ * @return If the slab could be allocated
+ */
+bool pool_allocator_grow(pool_allocator_t* allocator);
+
+/**
+ * Indicates if the blocks of a pool can hold objects of the given size and alignment.
+ * @param allocator A pool allocator
+ * @param size A size in bytes
+ * @param alignment A power of two
+ * @return If every block is large and aligned enough
+ */
+bool pool_allocator_holds(pool_allocator_t* allocator, size_t size, size_t alignment);
+
+/**
+ * Initializes a pool for the given type, checking once that its blocks can hold the type.  Requires a pool defined with
+ * `DEFINE_POOL/1` for the type.
+ * @param _pool A pointer to the pool allocator to initialize
+ * @param _Type The type
+ * @param _parent The allocator providing the slabs
+ * @param _slab_count The number of blocks requested from the parent allocator at once
+ * @return If the pool was initialized, which fails if the type is aligned beyond what blocks of its size can be
+ */
+#define pool_init(_pool, _Type, _parent, _slab_count) \
+    pool_init_##_Type((_pool), (_parent), (_slab_count))
+
+/**
+ * Using the given pool, creates a new block of memory for the given type, without going through the allocator
+ * interface.  Requires a pool defined with `DEFINE_POOL/1` for the type.
+ * @param _pool A pool allocator initialized with `pool_init/4` for the type
+ * @param _Type The type
+ * @return A pointer to memory, or `NULL` if the pool is exhausted
+ */
+#define pool_create(_pool, _Type) \
+    pool_create_##_Type(_pool)
+
+/**
+ * Using the given pool, destroys a pointer to memory previously created with `pool_create/2`.
+ * @param _pool A pool allocator
+ * @param _Type The type
+ * @param _memory A pointer to memory
+ */
+#define pool_destroy(_pool, _Type, _memory) \
+    pool_destroy_##_Type((_pool), (_memory))
+
+/**
+ * Defines `pool_init_Type`, `pool_create_Type` and `pool_destroy_Type`, initializing a pool for the given type and
+ * allocating and freeing its blocks inline.  The type must be complete and named by a single identifier, and the macro
+ * is used at file scope without a trailing semicolon.
+ * @param _Type The type
+ */
+#define DEFINE_POOL(_Type) \
+    static inline bool pool_init_##_Type(pool_allocator_t* pool, allocator_t* parent, size_t slab_count) \
+    { \
+        *pool = pool_allocator_init(parent, sizeof(_Type), slab_count); \
+        return pool_allocator_holds(pool, sizeof(_Type), _Alignof(_Type)); \
+    } \
+    static inline _Type* pool_create_##_Type(pool_allocator_t* pool) \
+    { \
+        if (pool->free == NULL && !pool_allocator_grow(pool)) \
+        { \
+            return NULL; \
+        } \
+        pool_block_t* block = pool->free; \
+        pool->free = block->next; \
+        return (_Type*) (void*) block; \
+    } \
+    static inline void pool_destroy_##_Type(pool_allocator_t* pool, _Type* memory) \
+    { \
+        if (memory != NULL) \
+        { \
+            pool_block_t* block = (pool_block_t*) (void*) memory; \
+            block->next = pool->free; \
+            pool->free = block; \
+        } \
+    }
+
+#endif
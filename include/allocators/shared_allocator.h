@@ -0,0 +1,112 @@
+#ifndef __ALLOCATORS__SHARED_ALLOCATOR__
+#define __ALLOCATORS__SHARED_ALLOCATOR__
+
+#include "allocators/allocator.h"
+#include "allocators/fixed_buffer_allocator.h"
+
+/**
+ * The size of the beginning of a shared memory region holding the state of the allocator, the heap following it.
+ */
+#define SHARED_HEADER_SIZE 8192
+
+/**
+ * The state of a shared heap, stored at the beginning of its region.
+ */
+typedef struct shared_region shared_region_t;
+
+/**
+ * A fixed buffer allocator over a region of memory shared between processes, so that a process can allocate a message
+ * in place and hand only its offset to another process.
+ *
+ * The region is a `memfd_create` file, whose descriptor is inherited or passed along, or a `shm_open` object found by
+ * name.  Every process maps it at the address chosen by the process creating it, so that the heap can be used by all of
+ * them, and offsets returned by `shared_allocator_offset/2` are what processes should exchange.  Processes forked after
+ * the heap is created inherit the mapping, and use the allocator as is instead of attaching to it.  Unrelated processes
+ * may fail to attach, since address space layout randomization can leave something else mapped at that address in them.
+ * The heap is protected by a robust process-shared mutex.  If a process dies while holding it, the heap is flagged
+ * damaged, since it may have been left halfway through an update, and every process then fails to allocate from it.
+ */
+typedef struct {
+    allocator_t allocator;
+    /**
+     * The file descriptor of the region.
+     */
+    int file;
+    /**
+     * The beginning of the mapping of the region.
+     */
+    char* base;
+    /**
+     * The size of the region in bytes.
+     */
+    size_t size;
+    /**
+     * The state of the heap, at the beginning of the mapping.
+     */
+    shared_region_t* region;
+} shared_allocator_t;
+
+/**
+ * Creates a shared heap.
+ * @param allocator A shared allocator, initialized by this function
+ * @param name The name of a new `shm_open` object, or `NULL` for an anonymous `memfd_create` file
+ * @param size The size in bytes of the region, larger than `SHARED_HEADER_SIZE`
+ * @param strategy The strategy of the heap, or `NULL` for first fit
+ * @param layout The layout of the heap, or `NULL` for the standard layout
+ * @return If the region could be created and mapped
+ */
+bool shared_allocator_create(
+    shared_allocator_t* allocator,
+    const char* name,
+    size_t size,
+    fixed_buffer_strategy_t* strategy,
+    fixed_buffer_layout_t* layout
+);
+
+/**
+ * Attaches to a shared heap created by another process, through the descriptor of its region.
+ * @param allocator A shared allocator, initialized by this function
+ * @param file The file descriptor of the region, duplicated by this function
+ * @return If the region holds a heap and could be mapped at the address of its creator
+ */
+bool shared_allocator_attach(shared_allocator_t* allocator, int file);
+
+/**
+ * Attaches to a shared heap created by another process, through the name of its region.
+ * @param allocator A shared allocator, initialized by this function
+ * @param name The name of the `shm_open` object
+ * @return If the region holds a heap and could be mapped at the address of its creator
+ */
+bool shared_allocator_open(shared_allocator_t* allocator, const char* name);
+
+/**
+ * Detaches from a shared heap, which lives on as long as a process is attached to it or, for a named region, until it is
+ * removed with `shm_unlink`.
+ * @param allocator A shared allocator
+ */
+void shared_allocator_detach(shared_allocator_t* allocator);
+
+/**
+ * Returns the offset of a pointer from the beginning of the region, which any process attached to it can resolve.
+ * @param allocator A shared allocator
+ * @param memory A pointer into the heap, or `NULL`
+ * @return An offset, or 0 for `NULL`
+ */
+size_t shared_allocator_offset(shared_allocator_t* allocator, void* memory);
+
+/**
+ * Returns the pointer at an offset from the beginning of the region.
+ * @param allocator A shared allocator
+ * @param offset An offset returned by `shared_allocator_offset/2` in any process, or 0
+ * @return A pointer, or `NULL` for 0
+ */
+void* shared_allocator_pointer(shared_allocator_t* allocator, size_t offset);
+
+/**
+ * Checks if a process died while updating a shared heap, which then cannot be used anymore.
+ * @param allocator A shared allocator, possibly not created or attached, or detached
+ * @return If the heap is damaged, false without a heap
+ */
+bool shared_allocator_is_damaged(shared_allocator_t* allocator);
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef __ALLOCATORS__STACK_ALLOCATOR__
+#define __ALLOCATORS__STACK_ALLOCATOR__
+
+#include "allocators/allocator.h"
+
+/**
+ * An allocator pushing blocks on top of each other in a buffer, to be freed in the reverse order.  Every block is
+ * preceded by a header of two words, linking it to the block below and recording its size.  A block freed while other
+ * blocks are above it is only flagged, and its memory is reclaimed once the blocks above it are freed, along with any
+ * flagged block below, or when a frame containing it is popped.
+ */
+typedef struct {
+    allocator_t allocator;
+    void* buffer;
+    size_t size;
+    /**
+     * The first free byte of the buffer.
+     */
+    char* top;
+    /**
+     * The memory of the block on top of the stack, or `NULL` if the stack is empty.
+     */
+    char* last;
+} stack_allocator_t;
+
+/**
+ * A position in a stack allocator, to which it can be brought back.
+ *
+ * All fields of a frame are considered private.
+ */
+typedef struct {
+    char* top;
+    char* last;
+} stack_frame_t;
+
+/**
+ * Initializes a stack allocator.
+ * @param buffer A buffer aligned on 8 bytes
+ * @param size The size of the buffer in bytes
+ * @return A stack allocator
+ */
+stack_allocator_t stack_allocator_init(void* buffer, size_t size);
+
+/**
+ * Starts a frame at the current top of a stack allocator.
+ * @param allocator A stack allocator
+ * @return A frame
+ */
+stack_frame_t stack_push_frame(stack_allocator_t* allocator);
+
+/**
+ * Frees all the blocks allocated since a frame was pushed, in constant time.  Frames pushed after this one must not be
+ * popped anymore.
+ * @param allocator A stack allocator
+ * @param frame A frame returned by `stack_push_frame/1`
+ */
+void stack_pop_frame(stack_allocator_t* allocator, stack_frame_t frame);
+
+#endif
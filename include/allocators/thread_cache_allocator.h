@@ -0,0 +1,114 @@
+#ifndef __ALLOCATORS__THREAD_CACHE_ALLOCATOR__
+#define __ALLOCATORS__THREAD_CACHE_ALLOCATOR__
+
+#include "allocators/allocator.h"
+
+#include <threads.h>
+
+/**
+ * The base 2 logarithm of the smallest size class.
+ */
+#define THREAD_CACHE_MIN_ORDER 4
+
+/**
+ * The number of size classes, each one twice as large as the previous one.  Larger blocks are not cached.
+ */
+#define THREAD_CACHE_CLASS_COUNT 9
+
+/**
+ * The largest number of blocks a thread keeps in a size class.
+ */
+#define THREAD_CACHE_CAPACITY 64
+
+/**
+ * The number of blocks moved at once between a thread and the parent allocator.
+ */
+#define THREAD_CACHE_BATCH (THREAD_CACHE_CAPACITY / 2)
+
+/**
+ * The blocks cached by a thread for a thread cache allocator.
+ */
+typedef struct thread_cache thread_cache_t;
+
+/**
+ * Counters of a thread cache allocator, summed over its threads.
+ */
+typedef struct {
+    /**
+     * The number of allocations served by the cache of a thread.
+     */
+    size_t allocation_hits;
+    /**
+     * The number of allocations that had to refill the cache of a thread from the parent allocator.
+     */
+    size_t allocation_misses;
+    /**
+     * The number of deallocations kept in the cache of a thread.
+     */
+    size_t deallocation_hits;
+    /**
+     * The number of deallocations that had to flush the cache of a thread to the parent allocator.
+     */
+    size_t deallocation_misses;
+    /**
+     * The number of allocations and deallocations too large to be cached.
+     */
+    size_t uncached;
+} thread_cache_stats_t;
+
+/**
+ * An allocator keeping, for every thread, a bounded number of freed blocks of every size class, so that most
+ * allocations and deallocations are served without a lock or an atomic operation.  Blocks move between a thread and the
+ * parent allocator in batches under a lock, and go back to the parent allocator when their thread exits.
+ *
+ * Every block is preceded by a header holding its size, so that it can be cached by size class when freed.
+ */
+typedef struct {
+    allocator_t allocator;
+    /**
+     * The allocator providing the blocks, which is only used under the lock.
+     */
+    allocator_t* parent;
+    /**
+     * The lock of the parent allocator and of the counters of exited threads.
+     */
+    mtx_t lock;
+    /**
+     * The cache of every thread.
+     */
+    tss_t caches;
+    /**
+     * The counters of the threads whose cache was flushed for good.
+     */
+    thread_cache_stats_t stats;
+} thread_cache_allocator_t;
+
+/**
+ * Initializes a thread cache allocator in place, since its lock and its thread-specific storage cannot be copied.
+ * @param allocator A thread cache allocator
+ * @param parent The allocator providing the blocks, which does not need to be thread-safe
+ * @return If the lock and the thread-specific storage could be created
+ */
+bool thread_cache_allocator_init(thread_cache_allocator_t* allocator, allocator_t* parent);
+
+/**
+ * Gives the blocks cached by the calling thread back to the parent allocator and destroys the allocator.  All other
+ * threads that used it must have exited.
+ * @param allocator A thread cache allocator
+ */
+void thread_cache_allocator_deinit(thread_cache_allocator_t* allocator);
+
+/**
+ * Gives the blocks cached by the calling thread back to the parent allocator, keeping its cache for later use.
+ * @param allocator A thread cache allocator
+ */
+void thread_cache_allocator_flush(thread_cache_allocator_t* allocator);
+
+/**
+ * Returns the counters of threads that exited, plus those of the calling thread.
+ * @param allocator A thread cache allocator
+ * @return Counters
+ */
+thread_cache_stats_t thread_cache_allocator_stats(thread_cache_allocator_t* allocator);
+
+#endif
@@ -12,6 +12,7 @@ enum mem_strategy {
     ms_best_fit,
     ms_worst_fit,
     ms_next_fit,
+    ms_tlsf,
 };
 
 void initmem(enum mem_strategy strategy, void* buffer, size_t size);
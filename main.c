@@ -72,6 +72,10 @@ void printMainMenu()
     {
         printf("NEXT FIT\n");
     }
+    else if (currentStrategy == ms_tlsf)
+    {
+        printf("TLSF\n");
+    }
     else
     {
         printf("UNKNOWN\n");
@@ -98,6 +102,7 @@ void printChangingStrategyMenu()
     printf("2 - BEST FIT\n");
     printf("3 - WORST FIT\n");
     printf("4 - NEXT FIT\n");
+    printf("5 - TLSF\n");
 
     userChoice = 0;
     safeInput(&userChoice);
@@ -121,6 +126,10 @@ void changeStrategy(int choice)
     {
         currentStrategy = ms_next_fit;
     }
+    else if (choice == 5)
+    {
+        currentStrategy = ms_tlsf;
+    }
 }
 
 int main()
@@ -10,7 +10,86 @@ void deallocate(allocator_t* allocator, void* memory)
     allocator->reallocate_fn(allocator, memory, 0);
 }
 
+void deallocate_sized(allocator_t* allocator, void* memory, size_t size)
+{
+    if (allocator->deallocate_sized_fn != NULL)
+    {
+        allocator->deallocate_sized_fn(allocator, memory, size);
+    }
+    else
+    {
+        allocator->reallocate_fn(allocator, memory, 0);
+    }
+}
+
+size_t allocate_batch(allocator_t* allocator, size_t size, size_t count, void** memories)
+{
+    if (allocator->allocate_batch_fn != NULL)
+    {
+        return allocator->allocate_batch_fn(allocator, size, count, memories);
+    }
+
+    size_t allocated = 0;
+
+    while (allocated < count)
+    {
+        void* memory = allocator->reallocate_fn(allocator, NULL, size);
+
+        if (memory == NULL)
+        {
+            break;
+        }
+
+        memories[allocated++] = memory;
+    }
+
+    return allocated;
+}
+
+void deallocate_batch(allocator_t* allocator, void** memories, size_t count)
+{
+    if (allocator->deallocate_batch_fn != NULL)
+    {
+        allocator->deallocate_batch_fn(allocator, memories, count);
+        return;
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (memories[i] != NULL)
+        {
+            allocator->reallocate_fn(allocator, memories[i], 0);
+        }
+    }
+}
+
 void* reallocate(allocator_t* allocator, void* memory, size_t size)
 {
     return allocator->reallocate_fn(allocator, memory, size);
 }
+
+void* allocate_aligned(allocator_t* allocator, size_t size, size_t alignment)
+{
+    return reallocate_aligned(allocator, NULL, size, alignment);
+}
+
+void* reallocate_aligned(allocator_t* allocator, void* memory, size_t size, size_t alignment)
+{
+    // Only powers of two are valid alignments.
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0)
+    {
+        return NULL;
+    }
+
+    if (allocator->reallocate_aligned_fn != NULL)
+    {
+        return allocator->reallocate_aligned_fn(allocator, memory, size, alignment);
+    }
+
+    if (alignment > _Alignof(max_align_t))
+    {
+        return NULL;
+    }
+
+    return allocator->reallocate_fn(allocator, memory, size);
+}
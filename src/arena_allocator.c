@@ -0,0 +1,285 @@
+#include "allocators/arena_allocator.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include "./macros.h"
+
+/**
+ * The alignment of all allocations, suitable for any fundamental type.
+ */
+#define ARENA_ALIGNMENT ((size_t) _Alignof(max_align_t))
+
+/**
+ * The size of the header of a chunk, keeping the memory following it aligned.
+ */
+#define ARENA_CHUNK_HEADER_SIZE ((sizeof(arena_chunk_t) + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1))
+
+struct arena_chunk {
+    /**
+     * The following chunk, or `NULL` for the last one.
+     */
+    struct arena_chunk* next;
+    /**
+     * The size of the memory following this chunk.
+     */
+    size_t size;
+};
+
+/**
+ * Returns a pointer to the memory associated with a chunk.
+ * @param chunk A chunk
+ * @return A pointer
+ */
+static char* arena_chunk_memory(arena_chunk_t* chunk)
+{
+    return (char*) chunk + ARENA_CHUNK_HEADER_SIZE;
+}
+
+/**
+ * Rounds a pointer up to an alignment.
+ * @param pointer A pointer
+ * @param alignment A power of two
+ * @return The aligned pointer
+ */
+static char* arena_align(char* pointer, size_t alignment)
+{
+    return pointer + (size_t) (-(uintptr_t) pointer & (alignment - 1));
+}
+
+/**
+ * Moves the arena to a chunk whose memory starts being bumped.
+ * @param allocator An arena allocator
+ * @param chunk A chunk of the arena
+ */
+static void arena_allocator_enter(arena_allocator_t* allocator, arena_chunk_t* chunk)
+{
+    allocator->current = chunk;
+    allocator->position = arena_chunk_memory(chunk);
+    allocator->end = allocator->position + chunk->size;
+}
+
+/**
+ * Moves the arena to a chunk able to hold `size` bytes with the given alignment, reusing the chunk following the
+ * current one when it is large enough, or else inserting a new chunk from the parent allocator before it.
+ * @param allocator An arena allocator
+ * @param size A size in bytes
+ * @param alignment A power of two, at least `ARENA_ALIGNMENT`
+ * @return If a chunk was found
+ */
+static bool arena_allocator_grow(arena_allocator_t* allocator, size_t size, size_t alignment)
+{
+    arena_chunk_t* next = allocator->current != NULL ? allocator->current->next : allocator->first;
+
+    // Chunk memory is already aligned on `ARENA_ALIGNMENT`, so only a stricter alignment may need padding.
+    size_t padding = alignment - ARENA_ALIGNMENT;
+
+    if (size > SIZE_MAX - ARENA_CHUNK_HEADER_SIZE - padding)
+    {
+        return false;
+    }
+
+    if (next != NULL && next->size >= size + padding)
+    {
+        arena_allocator_enter(allocator, next);
+        return true;
+    }
+
+    size_t chunk_size = size + padding > allocator->chunk_size ? size + padding : allocator->chunk_size;
+    arena_chunk_t* chunk = allocate_aligned(allocator->parent, ARENA_CHUNK_HEADER_SIZE + chunk_size, ARENA_ALIGNMENT);
+
+    if (chunk == NULL)
+    {
+        return false;
+    }
+
+    chunk->next = next;
+    chunk->size = chunk_size;
+
+    if (allocator->current != NULL)
+    {
+        allocator->current->next = chunk;
+    }
+    else
+    {
+        allocator->first = chunk;
+    }
+
+    arena_allocator_enter(allocator, chunk);
+
+    return true;
+}
+
+/**
+ * Returns the end of the bytes that can be copied from a previous allocation.  The size of allocations is not recorded,
+ * so this is the end of the used part of its chunk.
+ * @param allocator An arena allocator
+ * @param memory An allocation of the arena
+ * @return A pointer past `memory`, or `memory` itself if it does not belong to the arena
+ */
+static char* arena_allocator_limit(arena_allocator_t* allocator, char* memory)
+{
+    if (allocator->current != NULL && memory >= arena_chunk_memory(allocator->current) && memory < allocator->position)
+    {
+        return allocator->position;
+    }
+
+    for (arena_chunk_t* chunk = allocator->first; chunk != NULL; chunk = chunk->next)
+    {
+        char* begin = arena_chunk_memory(chunk);
+
+        if (memory >= begin && memory < begin + chunk->size)
+        {
+            return begin + chunk->size;
+        }
+    }
+
+    return memory;
+}
+
+static void* arena_allocator_reallocate_aligned(allocator_t* _allocator, void* _memory, size_t size, size_t alignment)
+{
+    arena_allocator_t* allocator = FIELD_PARENT_PTR(arena_allocator_t, allocator, _allocator);
+    char* memory = (char*) _memory;
+
+    if (alignment < ARENA_ALIGNMENT)
+    {
+        alignment = ARENA_ALIGNMENT;
+    }
+
+    // Only the last allocation can be given back, other frees wait for a reset.
+    if (size == 0)
+    {
+        if (memory != NULL && memory == allocator->last)
+        {
+            allocator->position = allocator->last;
+            allocator->last = NULL;
+        }
+
+        return NULL;
+    }
+
+    if (size > SIZE_MAX - ARENA_ALIGNMENT)
+    {
+        return NULL;
+    }
+
+    size = (size + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1);
+
+    // The last allocation is followed by free memory, so it can be resized in place.
+    if (
+        memory != NULL
+        && memory == allocator->last
+        && ((uintptr_t) memory & (alignment - 1)) == 0
+        && size <= (size_t) (allocator->end - memory)
+    )
+    {
+        allocator->position = memory + size;
+        return memory;
+    }
+
+    // The limit of the copy must be found before the arena moves to another chunk.
+    char* limit = memory != NULL ? arena_allocator_limit(allocator, memory) : NULL;
+
+    char* new_memory = allocator->current != NULL ? arena_align(allocator->position, alignment) : NULL;
+
+    if (new_memory == NULL || new_memory > allocator->end || size > (size_t) (allocator->end - new_memory))
+    {
+        if (!arena_allocator_grow(allocator, size, alignment))
+        {
+            return NULL;
+        }
+
+        new_memory = arena_align(allocator->position, alignment);
+    }
+
+    allocator->position = new_memory + size;
+    allocator->last = new_memory;
+
+    if (memory != NULL)
+    {
+        size_t copied = (size_t) (limit - memory);
+        memcpy(new_memory, memory, copied < size ? copied : size);
+    }
+
+    return new_memory;
+}
+
+static void* arena_allocator_reallocate(allocator_t* allocator, void* memory, size_t size)
+{
+    return arena_allocator_reallocate_aligned(allocator, memory, size, ARENA_ALIGNMENT);
+}
+
+static const allocator_t arena_allocator_vtable = {
+    arena_allocator_reallocate,
+    arena_allocator_reallocate_aligned,
+    NULL,
+    NULL,
+    NULL,
+};
+
+arena_allocator_t arena_allocator_init(allocator_t* parent, size_t chunk_size)
+{
+    arena_allocator_t allocator;
+    allocator.allocator = arena_allocator_vtable;
+    allocator.parent = parent;
+    allocator.chunk_size = chunk_size;
+    allocator.first = NULL;
+    allocator.current = NULL;
+    allocator.position = NULL;
+    allocator.end = NULL;
+    allocator.last = NULL;
+
+    return allocator;
+}
+
+void arena_allocator_deinit(arena_allocator_t* allocator)
+{
+    arena_chunk_t* chunk = allocator->first;
+
+    while (chunk != NULL)
+    {
+        arena_chunk_t* next = chunk->next;
+        deallocate_sized(allocator->parent, chunk, ARENA_CHUNK_HEADER_SIZE + chunk->size);
+        chunk = next;
+    }
+
+    allocator->first = NULL;
+    allocator->current = NULL;
+    allocator->position = NULL;
+    allocator->end = NULL;
+    allocator->last = NULL;
+}
+
+arena_mark_t arena_mark(arena_allocator_t* allocator)
+{
+    arena_mark_t mark;
+    mark.chunk = allocator->current;
+    mark.position = allocator->position;
+
+    return mark;
+}
+
+void arena_reset_to_mark(arena_allocator_t* allocator, arena_mark_t mark)
+{
+    // A mark taken before the first chunk was allocated is the beginning of the arena.
+    if (mark.chunk == NULL)
+    {
+        arena_reset(allocator);
+        return;
+    }
+
+    arena_allocator_enter(allocator, mark.chunk);
+    allocator->position = mark.position;
+    allocator->last = NULL;
+}
+
+void arena_reset(arena_allocator_t* allocator)
+{
+    if (allocator->first != NULL)
+    {
+        arena_allocator_enter(allocator, allocator->first);
+    }
+
+    allocator->last = NULL;
+}
@@ -0,0 +1,456 @@
+#include "allocators/buddy_allocator.h"
+
+#include <string.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include "./macros.h"
+
+/**
+ * The alignment of the region, so that every block is aligned for any fundamental type.
+ */
+#define BUDDY_ALIGNMENT ((size_t) _Alignof(max_align_t))
+
+struct buddy_block {
+    /**
+     * The previous free block of the same order, or `NULL` for the first one.
+     */
+    struct buddy_block* previous;
+    /**
+     * The next free block of the same order, or `NULL` for the last one.
+     */
+    struct buddy_block* next;
+};
+
+/**
+ * Counts the bits set in a word.
+ * @param bits A word
+ * @return A number of bits
+ */
+static unsigned buddy_popcount(uint32_t bits)
+{
+#if defined(_MSC_VER)
+    return (unsigned) __popcnt(bits);
+#else
+    return (unsigned) __builtin_popcount(bits);
+#endif
+}
+
+/**
+ * Returns the index of a block in the bitmaps.  Blocks are numbered level by level, starting with the root block.
+ * @param allocator A buddy allocator
+ * @param order The base 2 logarithm of the size of the block
+ * @param offset The offset of the block in the region
+ * @return An index
+ */
+static size_t buddy_node(buddy_allocator_t* allocator, unsigned order, size_t offset)
+{
+    return (((size_t) 1 << (allocator->top_order - order)) - 1) + (offset >> order);
+}
+
+static bool buddy_bitmap_get(uint32_t* bitmap, size_t index)
+{
+    return (bitmap[index / 32] >> (index % 32)) & 1;
+}
+
+static void buddy_bitmap_set(uint32_t* bitmap, size_t index)
+{
+    bitmap[index / 32] |= (uint32_t) 1 << (index % 32);
+}
+
+static void buddy_bitmap_clear(uint32_t* bitmap, size_t index)
+{
+    bitmap[index / 32] &= ~((uint32_t) 1 << (index % 32));
+}
+
+/**
+ * Counts the bits set in a range of a bitmap.
+ * @param bitmap A bitmap
+ * @param begin The index of the first bit
+ * @param end The index past the last bit
+ * @return A number of bits
+ */
+static size_t buddy_bitmap_count(uint32_t* bitmap, size_t begin, size_t end)
+{
+    size_t count = 0;
+
+    while (begin < end)
+    {
+        size_t bit = begin % 32;
+        size_t width = end - begin < 32 - bit ? end - begin : 32 - bit;
+        uint32_t mask = width == 32 ? UINT32_MAX : (((uint32_t) 1 << width) - 1) << bit;
+
+        count += buddy_popcount(bitmap[begin / 32] & mask);
+        begin += width;
+    }
+
+    return count;
+}
+
+/**
+ * Counts the free blocks of an order.
+ * @param allocator A buddy allocator
+ * @param order The base 2 logarithm of the size of the blocks
+ * @return A number of blocks
+ */
+static size_t buddy_allocator_free_blocks_of_order(buddy_allocator_t* allocator, unsigned order)
+{
+    if (allocator->region_size == 0)
+    {
+        return 0;
+    }
+
+    size_t begin = buddy_node(allocator, order, 0);
+    size_t end = begin + ((size_t) 1 << (allocator->top_order - order));
+
+    return buddy_bitmap_count(allocator->free_bitmap, begin, end);
+}
+
+/**
+ * Adds a block to the free list of its order.
+ * @param allocator A buddy allocator
+ * @param order The base 2 logarithm of the size of the block
+ * @param offset The offset of the block in the region
+ */
+static void buddy_block_push(buddy_allocator_t* allocator, unsigned order, size_t offset)
+{
+    buddy_block_t* block = (buddy_block_t*) (allocator->region + offset);
+    buddy_block_t* first = allocator->free_lists[order];
+
+    block->previous = NULL;
+    block->next = first;
+
+    if (first != NULL)
+    {
+        first->previous = block;
+    }
+
+    allocator->free_lists[order] = block;
+    buddy_bitmap_set(allocator->free_bitmap, buddy_node(allocator, order, offset));
+}
+
+/**
+ * Removes a block from the free list of its order.
+ * @param allocator A buddy allocator
+ * @param order The base 2 logarithm of the size of the block
+ * @param offset The offset of the block in the region
+ */
+static void buddy_block_remove(buddy_allocator_t* allocator, unsigned order, size_t offset)
+{
+    buddy_block_t* block = (buddy_block_t*) (allocator->region + offset);
+
+    if (block->previous != NULL)
+    {
+        block->previous->next = block->next;
+    }
+    else
+    {
+        allocator->free_lists[order] = block->next;
+    }
+
+    if (block->next != NULL)
+    {
+        block->next->previous = block->previous;
+    }
+
+    buddy_bitmap_clear(allocator->free_bitmap, buddy_node(allocator, order, offset));
+}
+
+/**
+ * Returns the order of the smallest block holding a size.
+ * @param size A size in bytes
+ * @return The base 2 logarithm of the size of a block
+ */
+static unsigned buddy_order(size_t size)
+{
+    unsigned order = BUDDY_MIN_ORDER;
+
+    while (((size_t) 1 << order) < size)
+    {
+        ++order;
+    }
+
+    return order;
+}
+
+/**
+ * Finds the order of an allocated block by going down the split blocks containing it.
+ * @param allocator A buddy allocator
+ * @param memory A pointer
+ * @param order Receives the base 2 logarithm of the size of the block
+ * @return If the memory is the beginning of an allocated block
+ */
+static bool buddy_allocator_find(buddy_allocator_t* allocator, void* memory, unsigned* order)
+{
+    char* pointer = (char*) memory;
+
+    if (pointer < allocator->region || pointer >= allocator->region + allocator->region_size)
+    {
+        return false;
+    }
+
+    size_t offset = (size_t) (pointer - allocator->region);
+    unsigned current = allocator->top_order;
+
+    while (current > BUDDY_MIN_ORDER && buddy_bitmap_get(allocator->split_bitmap, buddy_node(allocator, current, offset)))
+    {
+        --current;
+    }
+
+    // A pointer inside a block, or to a free block, is not one that was handed out.
+    if ((offset & (((size_t) 1 << current) - 1)) != 0 || buddy_bitmap_get(allocator->free_bitmap, buddy_node(allocator, current, offset)))
+    {
+        return false;
+    }
+
+    *order = current;
+
+    return true;
+}
+
+/**
+ * Allocates a block of an order, splitting a larger free block if needed.
+ * @param allocator A buddy allocator
+ * @param order The base 2 logarithm of the size of the block
+ * @return The memory of the block, or `NULL` if no block is large enough
+ */
+static void* buddy_allocator_reserve(buddy_allocator_t* allocator, unsigned order)
+{
+    unsigned current = order;
+
+    while (current <= allocator->top_order && allocator->free_lists[current] == NULL)
+    {
+        ++current;
+    }
+
+    if (current > allocator->top_order)
+    {
+        return NULL;
+    }
+
+    size_t offset = (size_t) ((char*) allocator->free_lists[current] - allocator->region);
+    buddy_block_remove(allocator, current, offset);
+
+    // The upper halves are given back while going down to the requested order.
+    while (current > order)
+    {
+        buddy_bitmap_set(allocator->split_bitmap, buddy_node(allocator, current, offset));
+        --current;
+        buddy_block_push(allocator, current, offset + ((size_t) 1 << current));
+    }
+
+    return allocator->region + offset;
+}
+
+/**
+ * Frees a block, merging it with its buddy as long as the buddy is free.
+ * @param allocator A buddy allocator
+ * @param order The base 2 logarithm of the size of the block
+ * @param offset The offset of the block in the region
+ */
+static void buddy_allocator_release(buddy_allocator_t* allocator, unsigned order, size_t offset)
+{
+    while (order < allocator->top_order)
+    {
+        size_t buddy = offset ^ ((size_t) 1 << order);
+
+        if (!buddy_bitmap_get(allocator->free_bitmap, buddy_node(allocator, order, buddy)))
+        {
+            break;
+        }
+
+        buddy_block_remove(allocator, order, buddy);
+
+        offset &= ~((size_t) 1 << order);
+        ++order;
+
+        buddy_bitmap_clear(allocator->split_bitmap, buddy_node(allocator, order, offset));
+    }
+
+    buddy_block_push(allocator, order, offset);
+}
+
+static void* buddy_allocator_reallocate(allocator_t* _allocator, void* memory, size_t size)
+{
+    buddy_allocator_t* allocator = FIELD_PARENT_PTR(buddy_allocator_t, allocator, _allocator);
+
+    if (memory == NULL && size == 0)
+    {
+        return NULL;
+    }
+    // No memory, but a size given, do memory allocation.
+    else if (memory == NULL)
+    {
+        if (size > allocator->region_size)
+        {
+            return NULL;
+        }
+
+        return buddy_allocator_reserve(allocator, buddy_order(size));
+    }
+
+    unsigned order;
+
+    if (!buddy_allocator_find(allocator, memory, &order))
+    {
+        return NULL;
+    }
+
+    size_t offset = (size_t) ((char*) memory - allocator->region);
+
+    // Memory is not null, do a free.
+    if (size == 0)
+    {
+        buddy_allocator_release(allocator, order, offset);
+        return NULL;
+    }
+
+    if (size > allocator->region_size)
+    {
+        return NULL;
+    }
+
+    unsigned new_order = buddy_order(size);
+
+    // Shrinking splits the block in place, giving back its upper halves.
+    if (new_order <= order)
+    {
+        while (order > new_order)
+        {
+            buddy_bitmap_set(allocator->split_bitmap, buddy_node(allocator, order, offset));
+            --order;
+            buddy_block_push(allocator, order, offset + ((size_t) 1 << order));
+        }
+
+        return memory;
+    }
+
+    void* new_memory = buddy_allocator_reserve(allocator, new_order);
+
+    if (new_memory == NULL)
+    {
+        return NULL;
+    }
+
+    memcpy(new_memory, memory, (size_t) 1 << order);
+    buddy_allocator_release(allocator, order, offset);
+
+    return new_memory;
+}
+
+static const allocator_t buddy_allocator_vtable = {
+    buddy_allocator_reallocate,
+    NULL,
+    NULL,
+    NULL,
+    NULL,
+};
+
+buddy_allocator_t buddy_allocator_init(void* buffer, size_t size)
+{
+    buddy_allocator_t allocator;
+    allocator.allocator = buddy_allocator_vtable;
+    allocator.buffer = buffer;
+    allocator.size = size;
+
+    for (size_t i = 0; i < BUDDY_ORDER_COUNT; ++i)
+    {
+        allocator.free_lists[i] = NULL;
+    }
+
+    // The tree is sized for the whole buffer, which bounds the region left once the bitmaps are taken out of it.
+    allocator.top_order = buddy_order(size);
+
+    size_t nodes = ((size_t) 1 << (allocator.top_order - BUDDY_MIN_ORDER + 1)) - 1;
+    size_t words = (nodes + 31) / 32;
+    size_t bitmaps_size = (2 * words * sizeof(uint32_t) + BUDDY_ALIGNMENT - 1) & ~(BUDDY_ALIGNMENT - 1);
+
+    allocator.free_bitmap = (uint32_t*) buffer;
+    allocator.split_bitmap = allocator.free_bitmap + words;
+    allocator.region = (char*) buffer + bitmaps_size;
+    allocator.region_size = 0;
+
+    // A buffer too small for its bitmaps has no blocks at all.
+    if (bitmaps_size >= size)
+    {
+        return allocator;
+    }
+
+    allocator.region_size = (size - bitmaps_size) & ~(((size_t) 1 << BUDDY_MIN_ORDER) - 1);
+
+    memset(buffer, 0, 2 * words * sizeof(uint32_t));
+
+    // The region is cut in the largest aligned blocks fitting in it, splitting the blocks containing them.
+    size_t offset = 0;
+
+    while (offset < allocator.region_size)
+    {
+        unsigned order = allocator.top_order;
+
+        while ((offset & (((size_t) 1 << order) - 1)) != 0 || ((size_t) 1 << order) > allocator.region_size - offset)
+        {
+            --order;
+        }
+
+        for (unsigned parent = allocator.top_order; parent > order; --parent)
+        {
+            buddy_bitmap_set(allocator.split_bitmap, buddy_node(&allocator, parent, offset & ~(((size_t) 1 << parent) - 1)));
+        }
+
+        buddy_block_push(&allocator, order, offset);
+        offset += (size_t) 1 << order;
+    }
+
+    return allocator;
+}
+
+size_t buddy_allocator_free_blocks(buddy_allocator_t* allocator)
+{
+    size_t count = 0;
+
+    for (unsigned order = BUDDY_MIN_ORDER; order <= allocator->top_order; ++order)
+    {
+        count += buddy_allocator_free_blocks_of_order(allocator, order);
+    }
+
+    return count;
+}
+
+size_t buddy_allocator_free_size(buddy_allocator_t* allocator)
+{
+    size_t size = 0;
+
+    for (unsigned order = BUDDY_MIN_ORDER; order <= allocator->top_order; ++order)
+    {
+        size += buddy_allocator_free_blocks_of_order(allocator, order) << order;
+    }
+
+    return size;
+}
+
+size_t buddy_allocator_largest_free(buddy_allocator_t* allocator)
+{
+    for (unsigned order = allocator->top_order; order >= BUDDY_MIN_ORDER; --order)
+    {
+        if (buddy_allocator_free_blocks_of_order(allocator, order) != 0)
+        {
+            return (size_t) 1 << order;
+        }
+    }
+
+    return 0;
+}
+
+size_t buddy_allocator_small_free(buddy_allocator_t* allocator, size_t threshold)
+{
+    size_t count = 0;
+
+    for (unsigned order = BUDDY_MIN_ORDER; order <= allocator->top_order && ((size_t) 1 << order) <= threshold; ++order)
+    {
+        count += buddy_allocator_free_blocks_of_order(allocator, order);
+    }
+
+    return count;
+}
@@ -1,9 +1,27 @@
 #include "allocators/c_allocator.h"
 
+#include <stddef.h>
+#include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#elif defined(__APPLE__)
+#include <malloc/malloc.h>
+#endif
 
 #include "./macros.h"
 
+/**
+ * The alignment of the memory returned by `malloc`, suitable for any fundamental type.
+ */
+#if defined(_MSC_VER)
+#define C_ALLOCATOR_ALIGNMENT (2 * sizeof(void*))
+#else
+#define C_ALLOCATOR_ALIGNMENT _Alignof(max_align_t)
+#endif
+
 static void* c_allocator_reallocate_callback(allocator_t* allocator, void* memory, size_t size)
 {
     UNUSED(allocator);
@@ -27,5 +45,82 @@ static void* c_allocator_reallocate_callback(allocator_t* allocator, void* memor
     }
 }
 
-static allocator_t c_allocator_state = { c_allocator_reallocate_callback };
+#if !defined(_MSC_VER)
+/**
+ * Returns how many bytes of a block of `malloc` are usable, which is at least its size.
+ * @param memory A block of `malloc`
+ * @return A size in bytes, or `SIZE_MAX` if the C library cannot tell
+ */
+static size_t c_allocator_usable_size(void* memory)
+{
+#if defined(__GLIBC__)
+    return malloc_usable_size(memory);
+#elif defined(__APPLE__)
+    return malloc_size(memory);
+#else
+    UNUSED(memory);
+
+    return SIZE_MAX;
+#endif
+}
+#endif
+
+static void* c_allocator_reallocate_aligned_callback(allocator_t* allocator, void* memory, size_t size, size_t alignment)
+{
+    // The memory of `malloc` is already aligned for any fundamental type.
+    if (alignment <= C_ALLOCATOR_ALIGNMENT || size == 0)
+    {
+        return c_allocator_reallocate_callback(allocator, memory, size);
+    }
+
+#if defined(_MSC_VER)
+    // Memory from `_aligned_malloc` must be freed with `_aligned_free`, so it cannot be mixed with that of `malloc`.
+    return NULL;
+#else
+    // `aligned_alloc` requires a size that is a multiple of the alignment.
+    if (size > SIZE_MAX - alignment + 1)
+    {
+        return NULL;
+    }
+
+    size = (size + alignment - 1) & ~(alignment - 1);
+
+    void* aligned_memory = aligned_alloc(alignment, size);
+
+    if (memory == NULL || aligned_memory == NULL)
+    {
+        return aligned_memory;
+    }
+
+    // `realloc` keeps the contents, but not the alignment.  The aligned block is reserved beforehand so that a failure
+    // leaves the memory untouched, and only the bytes `realloc` kept are copied to it.
+    size_t kept = c_allocator_usable_size(memory);
+    void* new_memory = realloc(memory, size);
+
+    if (new_memory == NULL)
+    {
+        free(aligned_memory);
+        return NULL;
+    }
+
+    if (((uintptr_t) new_memory & (alignment - 1)) == 0)
+    {
+        free(aligned_memory);
+        return new_memory;
+    }
+
+    memcpy(aligned_memory, new_memory, kept < size ? kept : size);
+    free(new_memory);
+
+    return aligned_memory;
+#endif
+}
+
+static allocator_t c_allocator_state = {
+    c_allocator_reallocate_callback,
+    c_allocator_reallocate_aligned_callback,
+    NULL,
+    NULL,
+    NULL,
+};
 allocator_t* c_allocator = &c_allocator_state;
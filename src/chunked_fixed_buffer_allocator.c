@@ -0,0 +1,314 @@
+#include "allocators/chunked_fixed_buffer_allocator.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include "./macros.h"
+
+/**
+ * The alignment of allocations made without an explicit alignment, matching fixed buffer allocators.
+ */
+#define CHUNKED_FIXED_BUFFER_ALIGNMENT ((size_t) 8)
+
+/**
+ * The alignment of chunks, suitable for any fundamental type.
+ */
+#define CHUNKED_FIXED_BUFFER_CHUNK_ALIGNMENT ((size_t) _Alignof(max_align_t))
+
+/**
+ * The size of a chunk, keeping the buffer of its heap following it aligned.
+ */
+#define CHUNKED_FIXED_BUFFER_CHUNK_HEADER_SIZE \
+    ((sizeof(chunked_fixed_buffer_chunk_t) + CHUNKED_FIXED_BUFFER_CHUNK_ALIGNMENT - 1) & ~(CHUNKED_FIXED_BUFFER_CHUNK_ALIGNMENT - 1))
+
+/**
+ * Unlinks a chunk from the list of chunks.
+ * @param allocator A chunked fixed buffer allocator
+ * @param chunk A chunk of the allocator
+ */
+static void chunked_fixed_buffer_chunk_unlink(chunked_fixed_buffer_allocator_t* allocator, chunked_fixed_buffer_chunk_t* chunk)
+{
+    if (chunk->previous != NULL)
+    {
+        chunk->previous->next = chunk->next;
+    }
+    else
+    {
+        allocator->chunks = chunk->next;
+    }
+
+    if (chunk->next != NULL)
+    {
+        chunk->next->previous = chunk->previous;
+    }
+}
+
+/**
+ * Links a chunk at the front of the list of chunks, where it is searched first.
+ * @param allocator A chunked fixed buffer allocator
+ * @param chunk A chunk not in the list
+ */
+static void chunked_fixed_buffer_chunk_push(chunked_fixed_buffer_allocator_t* allocator, chunked_fixed_buffer_chunk_t* chunk)
+{
+    chunk->previous = NULL;
+    chunk->next = allocator->chunks;
+
+    if (allocator->chunks != NULL)
+    {
+        allocator->chunks->previous = chunk;
+    }
+
+    allocator->chunks = chunk;
+}
+
+/**
+ * Obtains a chunk able to hold `size` bytes with the given alignment from the parent allocator.
+ * @param allocator A chunked fixed buffer allocator
+ * @param size A size in bytes
+ * @param alignment A power of two
+ * @return A chunk at the front of the list, or `NULL` if the parent allocator could not provide it
+ */
+static chunked_fixed_buffer_chunk_t* chunked_fixed_buffer_chunk_create(
+    chunked_fixed_buffer_allocator_t* allocator,
+    size_t size,
+    size_t alignment
+)
+{
+    // Room for the node header of the block, and for a hole in front of it if it has to be aligned.
+    size_t overhead = CHUNKED_FIXED_BUFFER_CHUNK_HEADER_SIZE + 3 * fixed_buffer_layout_header_size(FBL_STANDARD) + 2 * alignment;
+
+    if (size > (SIZE_MAX - overhead - CHUNKED_FIXED_BUFFER_CHUNK_ALIGNMENT) / 2)
+    {
+        return NULL;
+    }
+
+    size_t needed = size + overhead;
+
+    // TLSF looks for a hole in the size class above the request, which starts at most a sixteenth of it higher.
+    if (allocator->strategy == FBS_TLSF)
+    {
+        needed += needed >> FIXED_BUFFER_TLSF_SL_LOG2;
+    }
+
+    size_t chunk_size = needed > allocator->chunk_size ? needed : allocator->chunk_size;
+    chunk_size = (chunk_size + CHUNKED_FIXED_BUFFER_CHUNK_ALIGNMENT - 1) & ~(CHUNKED_FIXED_BUFFER_CHUNK_ALIGNMENT - 1);
+
+    chunked_fixed_buffer_chunk_t* chunk = allocate_aligned(allocator->parent, chunk_size, CHUNKED_FIXED_BUFFER_CHUNK_ALIGNMENT);
+
+    if (chunk == NULL)
+    {
+        return NULL;
+    }
+
+    chunk->size = chunk_size;
+    chunk->live = 0;
+    chunk->heap = fixed_buffer_allocator_init(
+        allocator->strategy,
+        (char*) chunk + CHUNKED_FIXED_BUFFER_CHUNK_HEADER_SIZE,
+        chunk_size - CHUNKED_FIXED_BUFFER_CHUNK_HEADER_SIZE
+    );
+
+    chunked_fixed_buffer_chunk_push(allocator, chunk);
+    allocator->size += chunk_size;
+
+    return chunk;
+}
+
+/**
+ * Gives a chunk back to the parent allocator.
+ * @param allocator A chunked fixed buffer allocator
+ * @param chunk A chunk of the allocator
+ */
+static void chunked_fixed_buffer_chunk_destroy(chunked_fixed_buffer_allocator_t* allocator, chunked_fixed_buffer_chunk_t* chunk)
+{
+    chunked_fixed_buffer_chunk_unlink(allocator, chunk);
+    allocator->size -= chunk->size;
+    deallocate_sized(allocator->parent, chunk, chunk->size);
+}
+
+chunked_fixed_buffer_chunk_t* chunked_fixed_buffer_chunk_find(chunked_fixed_buffer_allocator_t* allocator, void* memory)
+{
+    char* pointer = (char*) memory;
+
+    for (chunked_fixed_buffer_chunk_t* chunk = allocator->chunks; chunk != NULL; chunk = chunk->next)
+    {
+        char* buffer = (char*) chunk->heap.buffer;
+
+        if (pointer >= buffer && pointer < buffer + chunk->heap.size)
+        {
+            return chunk;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Allocates memory from the first chunk able to provide it, or else from a new chunk.  The chunk providing the memory
+ * is moved to the front of the list.
+ * @param allocator A chunked fixed buffer allocator
+ * @param size A size in bytes
+ * @param alignment A power of two
+ * @return A pointer, or `NULL` if no chunk could be obtained
+ */
+static void* chunked_fixed_buffer_allocate(chunked_fixed_buffer_allocator_t* allocator, size_t size, size_t alignment)
+{
+    for (chunked_fixed_buffer_chunk_t* chunk = allocator->chunks; chunk != NULL; chunk = chunk->next)
+    {
+        void* memory = reallocate_aligned(&chunk->heap.allocator, NULL, size, alignment);
+
+        if (memory != NULL)
+        {
+            chunk->live++;
+
+            if (chunk != allocator->chunks)
+            {
+                chunked_fixed_buffer_chunk_unlink(allocator, chunk);
+                chunked_fixed_buffer_chunk_push(allocator, chunk);
+            }
+
+            return memory;
+        }
+    }
+
+    chunked_fixed_buffer_chunk_t* chunk = chunked_fixed_buffer_chunk_create(allocator, size, alignment);
+
+    if (chunk == NULL)
+    {
+        return NULL;
+    }
+
+    void* memory = reallocate_aligned(&chunk->heap.allocator, NULL, size, alignment);
+
+    if (memory == NULL)
+    {
+        chunked_fixed_buffer_chunk_destroy(allocator, chunk);
+        return NULL;
+    }
+
+    chunk->live++;
+
+    return memory;
+}
+
+/**
+ * Frees memory in the chunk owning it, giving the chunk back to the parent allocator if it is left empty while the
+ * chunks exceed the high-water mark.
+ * @param allocator A chunked fixed buffer allocator
+ * @param chunk The chunk owning the memory
+ * @param memory A pointer
+ */
+static void chunked_fixed_buffer_free(chunked_fixed_buffer_allocator_t* allocator, chunked_fixed_buffer_chunk_t* chunk, void* memory)
+{
+    // Invalid frees are ignored like in fixed buffer allocators, and must not count as a block of the chunk.
+    if (fixed_buffer_node_find(&chunk->heap, memory) == NULL)
+    {
+        return;
+    }
+
+    deallocate(&chunk->heap.allocator, memory);
+
+    if (--chunk->live == 0 && allocator->size > allocator->high_water)
+    {
+        chunked_fixed_buffer_chunk_destroy(allocator, chunk);
+    }
+}
+
+static void* chunked_fixed_buffer_reallocate_aligned(allocator_t* _allocator, void* memory, size_t size, size_t alignment)
+{
+    chunked_fixed_buffer_allocator_t* allocator = FIELD_PARENT_PTR(chunked_fixed_buffer_allocator_t, allocator, _allocator);
+
+    if (memory == NULL && size == 0)
+    {
+        return NULL;
+    }
+    // No memory, but a size given, do memory allocation.
+    else if (memory == NULL)
+    {
+        return chunked_fixed_buffer_allocate(allocator, size, alignment);
+    }
+
+    chunked_fixed_buffer_chunk_t* chunk = chunked_fixed_buffer_chunk_find(allocator, memory);
+
+    if (chunk == NULL)
+    {
+        return NULL;
+    }
+
+    // Memory is not null, do a free in the chunk owning it.
+    if (size == 0)
+    {
+        chunked_fixed_buffer_free(allocator, chunk, memory);
+        return NULL;
+    }
+
+    // We have a pointer to memory, and a size, do a resize in the chunk owning it first.
+    void* new_memory = reallocate_aligned(&chunk->heap.allocator, memory, size, alignment);
+
+    if (new_memory != NULL)
+    {
+        return new_memory;
+    }
+
+    fixed_buffer_node_t* node = fixed_buffer_node_find(&chunk->heap, memory);
+
+    if (node == NULL)
+    {
+        return NULL;
+    }
+
+    size_t node_size = fixed_buffer_node_size(&chunk->heap, node);
+
+    // The chunk is full, so the memory moves to another one.
+    new_memory = chunked_fixed_buffer_allocate(allocator, size, alignment);
+
+    if (new_memory == NULL)
+    {
+        return NULL;
+    }
+
+    memcpy(new_memory, memory, node_size < size ? node_size : size);
+    chunked_fixed_buffer_free(allocator, chunk, memory);
+
+    return new_memory;
+}
+
+static void* chunked_fixed_buffer_reallocate(allocator_t* allocator, void* memory, size_t size)
+{
+    return chunked_fixed_buffer_reallocate_aligned(allocator, memory, size, CHUNKED_FIXED_BUFFER_ALIGNMENT);
+}
+
+static const allocator_t chunked_fixed_buffer_vtable = {
+    chunked_fixed_buffer_reallocate,
+    chunked_fixed_buffer_reallocate_aligned,
+    NULL,
+    NULL,
+    NULL,
+};
+
+chunked_fixed_buffer_allocator_t chunked_fixed_buffer_allocator_init(
+    fixed_buffer_strategy_t* strategy,
+    allocator_t* parent,
+    size_t chunk_size,
+    size_t high_water
+)
+{
+    chunked_fixed_buffer_allocator_t allocator;
+    allocator.allocator = chunked_fixed_buffer_vtable;
+    allocator.parent = parent;
+    allocator.strategy = strategy;
+    allocator.chunk_size = chunk_size;
+    allocator.high_water = high_water;
+    allocator.chunks = NULL;
+    allocator.size = 0;
+
+    return allocator;
+}
+
+void chunked_fixed_buffer_allocator_deinit(chunked_fixed_buffer_allocator_t* allocator)
+{
+    while (allocator->chunks != NULL)
+    {
+        chunked_fixed_buffer_chunk_destroy(allocator, allocator->chunks);
+    }
+}
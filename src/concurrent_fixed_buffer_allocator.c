@@ -0,0 +1,501 @@
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include "allocators/concurrent_fixed_buffer_allocator.h"
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "./macros.h"
+
+/**
+ * The mark of blocks waiting in a queue of remote frees.
+ */
+#define CONCURRENT_FIXED_BUFFER_QUEUED ((uintptr_t) UINT64_C(0x5245544F4D454651))
+
+struct concurrent_fixed_buffer_remote {
+    /**
+     * The block freed before this one, or `NULL` for the first one.
+     */
+    struct concurrent_fixed_buffer_remote* next;
+    /**
+     * `CONCURRENT_FIXED_BUFFER_QUEUED` while the block waits in a queue, so that freeing it again is noticed.
+     */
+    atomic_uintptr_t mark;
+};
+
+_Static_assert(
+    sizeof(concurrent_fixed_buffer_remote_t) <= 2 * sizeof(void*),
+    "a queued block must fit in the smallest block of a fixed buffer allocator"
+);
+
+/**
+ * The number given to the next thread using a concurrent fixed buffer allocator for the first time.
+ */
+static atomic_size_t concurrent_fixed_buffer_next_thread = 0;
+
+/**
+ * The number of the current thread plus one, or 0 if it has not used a concurrent fixed buffer allocator yet.
+ */
+static _Thread_local size_t concurrent_fixed_buffer_thread = 0;
+
+/**
+ * The number of shards past its routed one from which the current thread allocates first, moved forward every time it
+ * has to steal from another shard.  It is shared by all allocators, for which it is only a hint.
+ */
+static _Thread_local size_t concurrent_fixed_buffer_offset = 0;
+
+/**
+ * Returns the index of the shard from which the current thread allocates first.
+ * @param allocator A concurrent fixed buffer allocator
+ * @return An index
+ */
+static size_t concurrent_fixed_buffer_home(concurrent_fixed_buffer_allocator_t* allocator)
+{
+#if defined(__linux__)
+    if (allocator->routing == CFBR_CPU)
+    {
+        int cpu = sched_getcpu();
+
+        if (cpu >= 0)
+        {
+            return ((size_t) cpu + concurrent_fixed_buffer_offset) % allocator->shard_count;
+        }
+    }
+#endif
+
+    if (concurrent_fixed_buffer_thread == 0)
+    {
+        concurrent_fixed_buffer_thread = atomic_fetch_add_explicit(&concurrent_fixed_buffer_next_thread, 1, memory_order_relaxed) + 1;
+    }
+
+    return (concurrent_fixed_buffer_thread - 1 + concurrent_fixed_buffer_offset) % allocator->shard_count;
+}
+
+concurrent_fixed_buffer_shard_t* concurrent_fixed_buffer_shard_find(
+    concurrent_fixed_buffer_allocator_t* allocator,
+    void* memory
+)
+{
+    char* pointer = (char*) memory;
+
+    if (pointer < allocator->region || pointer >= allocator->region + allocator->shard_count * allocator->shard_size)
+    {
+        return NULL;
+    }
+
+    return &allocator->shards[(size_t) (pointer - allocator->region) / allocator->shard_size];
+}
+
+/**
+ * Gives the blocks freed by other threads back to the heap of a shard, in batches so that adjacent blocks are merged
+ * together.  The lock of the shard must be held.
+ * @param shard A shard
+ */
+static void concurrent_fixed_buffer_drain(concurrent_fixed_buffer_shard_t* shard)
+{
+    if (atomic_load_explicit(&shard->remote, memory_order_relaxed) == NULL)
+    {
+        return;
+    }
+
+    concurrent_fixed_buffer_remote_t* block = atomic_exchange_explicit(&shard->remote, NULL, memory_order_acquire);
+    void* memories[CONCURRENT_FIXED_BUFFER_DRAIN_BATCH];
+
+    while (block != NULL)
+    {
+        size_t count = 0;
+
+        while (block != NULL && count < CONCURRENT_FIXED_BUFFER_DRAIN_BATCH)
+        {
+            memories[count++] = block;
+            atomic_store_explicit(&block->mark, 0, memory_order_relaxed);
+            block = block->next;
+        }
+
+        deallocate_batch(&shard->heap.allocator, memories, count);
+        shard->stats.remote_frees += count;
+    }
+}
+
+/**
+ * Frees memory in the shard owning it.  The lock is waited for only if it is the home shard of the current thread.
+ * Otherwise the memory is freed at once if the lock is free, and else queued for the next thread locking the shard.
+ * @param allocator A concurrent fixed buffer allocator
+ * @param shard The shard owning the memory
+ * @param memory A pointer
+ */
+static void concurrent_fixed_buffer_free(
+    concurrent_fixed_buffer_allocator_t* allocator,
+    concurrent_fixed_buffer_shard_t* shard,
+    void* memory
+)
+{
+    if (shard == &allocator->shards[concurrent_fixed_buffer_home(allocator)])
+    {
+        mtx_lock(&shard->lock);
+        concurrent_fixed_buffer_drain(shard);
+        deallocate(&shard->heap.allocator, memory);
+        shard->stats.local_frees++;
+        mtx_unlock(&shard->lock);
+
+        return;
+    }
+
+    // The heap checks the memory is a live block before freeing it, which only the holder of the lock can do.
+    if (mtx_trylock(&shard->lock) == thrd_success)
+    {
+        concurrent_fixed_buffer_drain(shard);
+        deallocate(&shard->heap.allocator, memory);
+        shard->stats.remote_frees++;
+        mtx_unlock(&shard->lock);
+
+        return;
+    }
+
+    // Queuing writes into the memory, which must not be a hole, whose links it would overwrite without the lock.  A block
+    // freed and merged into a hole has its tag cleared or is the head of the hole, so only its own header is checked.
+    if (fixed_buffer_node_peek(&shard->heap, memory) == NULL)
+    {
+        return;
+    }
+
+    concurrent_fixed_buffer_remote_t* block = (concurrent_fixed_buffer_remote_t*) memory;
+
+    // A block freed twice before being drained would link the queue into a cycle, so the second free is ignored.
+    if (atomic_exchange_explicit(&block->mark, CONCURRENT_FIXED_BUFFER_QUEUED, memory_order_relaxed) == CONCURRENT_FIXED_BUFFER_QUEUED)
+    {
+        return;
+    }
+
+    concurrent_fixed_buffer_remote_t* head = atomic_load_explicit(&shard->remote, memory_order_relaxed);
+
+    // Blocks are only ever taken all at once, so a head that was popped and pushed back cannot corrupt the queue.
+    do
+    {
+        block->next = head;
+    }
+    while (!atomic_compare_exchange_weak_explicit(&shard->remote, &head, block, memory_order_release, memory_order_relaxed));
+}
+
+/**
+ * Counts an allocation from a shard, making it the first shard the current thread allocates from if it is not its home
+ * shard.  The lock of the shard must be held.
+ * @param allocator A concurrent fixed buffer allocator
+ * @param home The index of the home shard of the current thread
+ * @param distance The number of shards between the home shard and the shard allocated from
+ * @param count The number of blocks allocated
+ */
+static void concurrent_fixed_buffer_allocated(
+    concurrent_fixed_buffer_allocator_t* allocator,
+    size_t home,
+    size_t distance,
+    size_t count
+)
+{
+    concurrent_fixed_buffer_shard_t* shard = &allocator->shards[(home + distance) % allocator->shard_count];
+    shard->stats.allocations += count;
+
+    if (distance != 0 && count != 0)
+    {
+        shard->stats.steals += count;
+        concurrent_fixed_buffer_offset += distance;
+    }
+}
+
+/**
+ * Allocates memory from the home shard of the current thread, or else from the first other shard able to provide it.
+ * @param allocator A concurrent fixed buffer allocator
+ * @param size A size in bytes
+ * @param alignment A power of two
+ * @param skipped A shard not to allocate from, or `NULL`
+ * @return A pointer, or `NULL` if no shard has enough memory
+ */
+static void* concurrent_fixed_buffer_allocate(
+    concurrent_fixed_buffer_allocator_t* allocator,
+    size_t size,
+    size_t alignment,
+    concurrent_fixed_buffer_shard_t* skipped
+)
+{
+    if (allocator->shard_count == 0)
+    {
+        return NULL;
+    }
+
+    size_t home = concurrent_fixed_buffer_home(allocator);
+
+    for (size_t i = 0; i < allocator->shard_count; ++i)
+    {
+        concurrent_fixed_buffer_shard_t* shard = &allocator->shards[(home + i) % allocator->shard_count];
+
+        if (shard == skipped)
+        {
+            continue;
+        }
+
+        mtx_lock(&shard->lock);
+        concurrent_fixed_buffer_drain(shard);
+        void* memory = reallocate_aligned(&shard->heap.allocator, NULL, size, alignment);
+
+        if (memory != NULL)
+        {
+            concurrent_fixed_buffer_allocated(allocator, home, i, 1);
+        }
+        else
+        {
+            shard->stats.failures++;
+        }
+
+        mtx_unlock(&shard->lock);
+
+        if (memory != NULL)
+        {
+            return memory;
+        }
+    }
+
+    return NULL;
+}
+
+static void* concurrent_fixed_buffer_reallocate_aligned(allocator_t* _allocator, void* memory, size_t size, size_t alignment)
+{
+    concurrent_fixed_buffer_allocator_t* allocator = FIELD_PARENT_PTR(concurrent_fixed_buffer_allocator_t, allocator, _allocator);
+
+    if (memory == NULL && size == 0)
+    {
+        return NULL;
+    }
+    // No memory, but a size given, do memory allocation.
+    else if (memory == NULL)
+    {
+        return concurrent_fixed_buffer_allocate(allocator, size, alignment, NULL);
+    }
+
+    concurrent_fixed_buffer_shard_t* shard = concurrent_fixed_buffer_shard_find(allocator, memory);
+
+    if (shard == NULL)
+    {
+        return NULL;
+    }
+
+    // Memory is not null, do a free in the shard owning it.
+    if (size == 0)
+    {
+        concurrent_fixed_buffer_free(allocator, shard, memory);
+        return NULL;
+    }
+
+    // We have a pointer to memory, and a size, do a resize in the shard owning it first.
+    mtx_lock(&shard->lock);
+    concurrent_fixed_buffer_drain(shard);
+
+    void* new_memory = reallocate_aligned(&shard->heap.allocator, memory, size, alignment);
+    fixed_buffer_node_t* node = new_memory == NULL ? fixed_buffer_node_find(&shard->heap, memory) : NULL;
+    size_t node_size = node != NULL ? fixed_buffer_node_size(&shard->heap, node) : 0;
+
+    mtx_unlock(&shard->lock);
+
+    if (new_memory != NULL || node == NULL)
+    {
+        return new_memory;
+    }
+
+    // The shard is exhausted, so the memory moves to another one.  No two locks are ever held at once.
+    new_memory = concurrent_fixed_buffer_allocate(allocator, size, alignment, shard);
+
+    if (new_memory == NULL)
+    {
+        return NULL;
+    }
+
+    memcpy(new_memory, memory, node_size < size ? node_size : size);
+    concurrent_fixed_buffer_free(allocator, shard, memory);
+
+    return new_memory;
+}
+
+static void* concurrent_fixed_buffer_reallocate(allocator_t* allocator, void* memory, size_t size)
+{
+    return concurrent_fixed_buffer_reallocate_aligned(allocator, memory, size, 1);
+}
+
+static void concurrent_fixed_buffer_deallocate_sized(allocator_t* _allocator, void* memory, size_t size)
+{
+    concurrent_fixed_buffer_allocator_t* allocator = FIELD_PARENT_PTR(concurrent_fixed_buffer_allocator_t, allocator, _allocator);
+    concurrent_fixed_buffer_shard_t* shard = concurrent_fixed_buffer_shard_find(allocator, memory);
+
+    if (shard == NULL)
+    {
+        return;
+    }
+
+    if (shard != &allocator->shards[concurrent_fixed_buffer_home(allocator)])
+    {
+        concurrent_fixed_buffer_free(allocator, shard, memory);
+        return;
+    }
+
+    mtx_lock(&shard->lock);
+    concurrent_fixed_buffer_drain(shard);
+    deallocate_sized(&shard->heap.allocator, memory, size);
+    shard->stats.local_frees++;
+    mtx_unlock(&shard->lock);
+}
+
+static size_t concurrent_fixed_buffer_allocate_batch(allocator_t* _allocator, size_t size, size_t count, void** memories)
+{
+    concurrent_fixed_buffer_allocator_t* allocator = FIELD_PARENT_PTR(concurrent_fixed_buffer_allocator_t, allocator, _allocator);
+    size_t allocated = 0;
+
+    if (allocator->shard_count == 0)
+    {
+        return 0;
+    }
+
+    size_t home = concurrent_fixed_buffer_home(allocator);
+
+    // The whole batch is carved under a single lock of the home shard, the other shards completing it if needed.
+    for (size_t i = 0; i < allocator->shard_count && allocated < count; ++i)
+    {
+        concurrent_fixed_buffer_shard_t* shard = &allocator->shards[(home + i) % allocator->shard_count];
+
+        mtx_lock(&shard->lock);
+        concurrent_fixed_buffer_drain(shard);
+        size_t shard_allocated = allocate_batch(&shard->heap.allocator, size, count - allocated, memories + allocated);
+        concurrent_fixed_buffer_allocated(allocator, home, i, shard_allocated);
+
+        if (allocated + shard_allocated < count)
+        {
+            shard->stats.failures++;
+        }
+
+        mtx_unlock(&shard->lock);
+        allocated += shard_allocated;
+    }
+
+    return allocated;
+}
+
+static const allocator_t concurrent_fixed_buffer_vtable = {
+    concurrent_fixed_buffer_reallocate,
+    concurrent_fixed_buffer_reallocate_aligned,
+    concurrent_fixed_buffer_deallocate_sized,
+    concurrent_fixed_buffer_allocate_batch,
+    NULL,
+};
+
+concurrent_fixed_buffer_allocator_t concurrent_fixed_buffer_allocator_init(
+    fixed_buffer_strategy_t* strategy,
+    size_t shard_count,
+    void* buffer,
+    size_t size
+)
+{
+    return concurrent_fixed_buffer_allocator_init_with_routing(strategy, CFBR_THREAD, shard_count, buffer, size);
+}
+
+concurrent_fixed_buffer_allocator_t concurrent_fixed_buffer_allocator_init_with_routing(
+    fixed_buffer_strategy_t* strategy,
+    concurrent_fixed_buffer_routing_t routing,
+    size_t shard_count,
+    void* buffer,
+    size_t size
+)
+{
+    concurrent_fixed_buffer_allocator_t allocator;
+    allocator.allocator = concurrent_fixed_buffer_vtable;
+    allocator.buffer = buffer;
+    allocator.size = size;
+    allocator.shards = NULL;
+    allocator.shard_count = 0;
+    allocator.routing = routing;
+    allocator.region = (char*) buffer;
+    allocator.shard_size = 0;
+
+    // The shards are stored first, aligned on a cache line, and the rest of the buffer is divided between them.
+    size_t padding = (size_t) (-(uintptr_t) buffer & (CONCURRENT_FIXED_BUFFER_CACHE_LINE - 1));
+
+    if (shard_count == 0 || padding > size || shard_count > (size - padding) / sizeof(concurrent_fixed_buffer_shard_t))
+    {
+        return allocator;
+    }
+
+    char* shards = (char*) buffer + padding;
+    char* region = shards + shard_count * sizeof(concurrent_fixed_buffer_shard_t);
+    size_t shard_size = ((size - (size_t) (region - (char*) buffer)) / shard_count) & ~(size_t) (CONCURRENT_FIXED_BUFFER_CACHE_LINE - 1);
+
+    if (shard_size == 0)
+    {
+        return allocator;
+    }
+
+    allocator.shards = (concurrent_fixed_buffer_shard_t*) shards;
+    allocator.region = region;
+    allocator.shard_size = shard_size;
+
+    for (size_t i = 0; i < shard_count; ++i)
+    {
+        concurrent_fixed_buffer_shard_t* shard = &allocator.shards[i];
+
+        if (mtx_init(&shard->lock, mtx_plain) != thrd_success)
+        {
+            allocator.shard_count = i;
+            concurrent_fixed_buffer_allocator_deinit(&allocator);
+            return allocator;
+        }
+
+        shard->heap = fixed_buffer_allocator_init(strategy, region + i * shard_size, shard_size);
+        memset(&shard->stats, 0, sizeof(concurrent_fixed_buffer_stats_t));
+        atomic_init(&shard->remote, NULL);
+        allocator.shard_count = i + 1;
+    }
+
+    return allocator;
+}
+
+void concurrent_fixed_buffer_allocator_drain(concurrent_fixed_buffer_allocator_t* allocator)
+{
+    for (size_t i = 0; i < allocator->shard_count; ++i)
+    {
+        concurrent_fixed_buffer_shard_t* shard = &allocator->shards[i];
+
+        mtx_lock(&shard->lock);
+        concurrent_fixed_buffer_drain(shard);
+        mtx_unlock(&shard->lock);
+    }
+}
+
+void concurrent_fixed_buffer_allocator_deinit(concurrent_fixed_buffer_allocator_t* allocator)
+{
+    // The heaps outlive the allocator in the buffer, so they are left with every freed block in them.
+    concurrent_fixed_buffer_allocator_drain(allocator);
+
+    for (size_t i = 0; i < allocator->shard_count; ++i)
+    {
+        mtx_destroy(&allocator->shards[i].lock);
+    }
+
+    allocator->shards = NULL;
+    allocator->shard_count = 0;
+}
+
+concurrent_fixed_buffer_stats_t concurrent_fixed_buffer_shard_stats(
+    concurrent_fixed_buffer_allocator_t* allocator,
+    size_t index
+)
+{
+    concurrent_fixed_buffer_shard_t* shard = &allocator->shards[index];
+
+    mtx_lock(&shard->lock);
+    concurrent_fixed_buffer_stats_t stats = shard->stats;
+    mtx_unlock(&shard->lock);
+
+    return stats;
+}
@@ -0,0 +1,144 @@
+#include "allocators/fallback_allocator.h"
+#include "allocators/fixed_buffer_allocator.h"
+
+#include <string.h>
+
+#include "./macros.h"
+
+bool fallback_allocator_owns_primary(fallback_allocator_t* allocator, void* memory)
+{
+    char* pointer = (char*) memory;
+
+    return pointer >= allocator->begin && pointer < allocator->end;
+}
+
+/**
+ * Reallocates memory with an allocator, with its default alignment if none is given.
+ * @param allocator An allocator
+ * @param memory A pointer, or `NULL`
+ * @param size A size in bytes
+ * @param alignment A power of two, or 0 for the default alignment of the allocator
+ * @return A pointer, or `NULL`
+ */
+static void* fallback_reallocate_with(allocator_t* allocator, void* memory, size_t size, size_t alignment)
+{
+    return alignment == 0 ? reallocate(allocator, memory, size) : reallocate_aligned(allocator, memory, size, alignment);
+}
+
+/**
+ * Reallocates memory from the primary allocator if possible, or else from the secondary allocator.
+ * @param allocator A fallback allocator
+ * @param memory A pointer, or `NULL`
+ * @param size A size in bytes
+ * @param alignment A power of two, or 0 for the default alignment of the allocators
+ * @return A pointer, or `NULL`
+ */
+static void* fallback_reallocate(fallback_allocator_t* allocator, void* memory, size_t size, size_t alignment)
+{
+    if (memory == NULL && size == 0)
+    {
+        return NULL;
+    }
+    // No memory, but a size given, allocate from the primary allocator first.
+    else if (memory == NULL)
+    {
+        void* new_memory = fallback_reallocate_with(allocator->primary, NULL, size, alignment);
+
+        return new_memory != NULL ? new_memory : fallback_reallocate_with(allocator->secondary, NULL, size, alignment);
+    }
+
+    // Blocks of the secondary allocator are left to it entirely.
+    if (!fallback_allocator_owns_primary(allocator, memory))
+    {
+        return fallback_reallocate_with(allocator->secondary, memory, size, alignment);
+    }
+
+    if (size == 0)
+    {
+        return fallback_reallocate_with(allocator->primary, memory, 0, alignment);
+    }
+
+    // A pointer that is not a block is refused by the primary allocator for that reason, not because it is full.
+    size_t old_size = allocator->size_fn(allocator->primary, memory);
+
+    if (old_size == 0)
+    {
+        return NULL;
+    }
+
+    void* new_memory = fallback_reallocate_with(allocator->primary, memory, size, alignment);
+
+    if (new_memory != NULL)
+    {
+        return new_memory;
+    }
+
+    // The primary allocator is full, so the block moves to the secondary allocator.
+    new_memory = fallback_reallocate_with(allocator->secondary, NULL, size, alignment);
+
+    if (new_memory == NULL)
+    {
+        return NULL;
+    }
+
+    memcpy(new_memory, memory, old_size < size ? old_size : size);
+    deallocate(allocator->primary, memory);
+
+    return new_memory;
+}
+
+static void* fallback_allocator_reallocate(allocator_t* _allocator, void* memory, size_t size)
+{
+    fallback_allocator_t* allocator = FIELD_PARENT_PTR(fallback_allocator_t, allocator, _allocator);
+
+    return fallback_reallocate(allocator, memory, size, 0);
+}
+
+static void* fallback_allocator_reallocate_aligned(allocator_t* _allocator, void* memory, size_t size, size_t alignment)
+{
+    fallback_allocator_t* allocator = FIELD_PARENT_PTR(fallback_allocator_t, allocator, _allocator);
+
+    return fallback_reallocate(allocator, memory, size, alignment);
+}
+
+static void fallback_allocator_deallocate_sized(allocator_t* _allocator, void* memory, size_t size)
+{
+    fallback_allocator_t* allocator = FIELD_PARENT_PTR(fallback_allocator_t, allocator, _allocator);
+
+    deallocate_sized(fallback_allocator_owns_primary(allocator, memory) ? allocator->primary : allocator->secondary, memory, size);
+}
+
+static const allocator_t fallback_allocator_vtable = {
+    fallback_allocator_reallocate,
+    fallback_allocator_reallocate_aligned,
+    fallback_allocator_deallocate_sized,
+    NULL,
+    NULL,
+};
+
+fallback_allocator_t fallback_allocator_init(
+    allocator_t* primary,
+    void* buffer,
+    size_t size,
+    fallback_size_fn_t size_fn,
+    allocator_t* secondary
+)
+{
+    fallback_allocator_t allocator;
+    allocator.allocator = fallback_allocator_vtable;
+    allocator.primary = primary;
+    allocator.secondary = secondary;
+    allocator.size_fn = size_fn;
+    allocator.begin = (char*) buffer;
+    allocator.end = (char*) buffer + size;
+
+    return allocator;
+}
+
+size_t fallback_fixed_buffer_size(allocator_t* primary, void* memory)
+{
+    fixed_buffer_allocator_t* allocator = FIELD_PARENT_PTR(fixed_buffer_allocator_t, allocator, primary);
+    fixed_buffer_node_t* node = fixed_buffer_node_find(allocator, memory);
+
+    return node != NULL ? fixed_buffer_node_size(allocator, node) : 0;
+}
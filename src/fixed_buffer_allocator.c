@@ -1,227 +1,1669 @@
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
 #include "allocators/fixed_buffer_allocator.h"
 
 #include <assert.h>
+#include <stdlib.h>
 #include <string.h>
 
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 #include "./macros.h"
 
-void* fixed_buffer_node_memory(fixed_buffer_node_t* node)
+/**
+ * The alignment of node headers, and therefore of the memory following them.
+ */
+#define FIXED_BUFFER_ALIGNMENT ((size_t) 8)
+
+/**
+ * The tag written in the header of every live node.  Headers absorbed by a neighboring hole have their tag cleared.
+ */
+#define FIXED_BUFFER_NODE_MAGIC 0xFBA110C8u
+
+/**
+ * The tag written in the upper bits of every live compact header.
+ */
+#define FIXED_BUFFER_COMPACT_MAGIC UINT64_C(0xFBA1)
+#define FIXED_BUFFER_COMPACT_MAGIC_SHIFT 48
+
+/**
+ * The flags and the size packed in a compact header.  Sizes are multiples of the alignment, so their low bits are free.
+ */
+#define FIXED_BUFFER_COMPACT_HOLE UINT64_C(0x1)
+#define FIXED_BUFFER_COMPACT_PREVIOUS_HOLE UINT64_C(0x2)
+#define FIXED_BUFFER_COMPACT_DECOMMITTED UINT64_C(0x4)
+#define FIXED_BUFFER_COMPACT_SIZE_MASK UINT64_C(0x0000FFFFFFFFFFF8)
+
+/**
+ * A node header in the standard layout.
+ */
+struct fixed_buffer_node {
+    /**
+     * Indicates if this node is a hole.
+     */
+    bool is_hole;
+    /**
+     * Indicates if the pages inside this hole were given back to the system.
+     */
+    bool is_decommitted;
+    /**
+     * A tag identifying a live node header, allowing foreign or stale pointers to be rejected without a scan.
+     */
+    uint32_t magic;
+    /**
+     * The size of the memory following this node.
+     */
+    size_t size;
+    /**
+     * A pointer to the previous node in memory.
+     */
+    struct fixed_buffer_node* previous;
+};
+
+/**
+ * The links of the index in which a hole is kept, stored in the memory of every hole.
+ */
+typedef union fixed_buffer_hole {
+    /**
+     * The links of a hole kept in a list.
+     */
+    struct {
+        /**
+         * The previous hole in the list, or `NULL` for the first hole.
+         */
+        fixed_buffer_node_t* previous;
+        /**
+         * The next hole in the list, or `NULL` for the last hole.
+         */
+        fixed_buffer_node_t* next;
+    };
+    /**
+     * The links of a hole kept in a tree.
+     */
+    struct {
+        /**
+         * The root of the subtree of smaller holes.
+         */
+        fixed_buffer_node_t* left;
+        /**
+         * The root of the subtree of larger holes.
+         */
+        fixed_buffer_node_t* right;
+    };
+} fixed_buffer_hole_t;
+
+struct fixed_buffer_layout {
+    /**
+     * The size of a node header.
+     */
+    size_t header_size;
+    /**
+     * The smallest size of the memory of a node, so that it can hold the links of a hole once released.
+     */
+    size_t min_size;
+    /**
+     * Indicates if headers are packed in a single word, with the size of the previous hole in a footer.
+     */
+    bool compact;
+};
+
+static fixed_buffer_layout_t standard_layout_state = {
+    .header_size = sizeof(struct fixed_buffer_node),
+    .min_size = sizeof(fixed_buffer_hole_t),
+    .compact = false,
+};
+
+fixed_buffer_layout_t* FBL_STANDARD = &standard_layout_state;
+
+static fixed_buffer_layout_t compact_layout_state = {
+    .header_size = sizeof(uint64_t),
+    .min_size = sizeof(fixed_buffer_hole_t) + sizeof(uint64_t),
+    .compact = true,
+};
+
+fixed_buffer_layout_t* FBL_COMPACT = &compact_layout_state;
+
+size_t fixed_buffer_layout_header_size(fixed_buffer_layout_t* layout)
+{
+    return layout->header_size;
+}
+
+/**
+ * Returns the compact header of a node.
+ * @param node A node of an allocator using the compact layout
+ * @return A pointer to the header word
+ */
+static uint64_t* fixed_buffer_node_compact(fixed_buffer_node_t* node)
+{
+    return (uint64_t*) node;
+}
+
+void* fixed_buffer_node_memory(fixed_buffer_allocator_t* allocator, fixed_buffer_node_t* node)
+{
+    return (void*) ((char*) node + allocator->layout->header_size);
+}
+
+size_t fixed_buffer_node_size(fixed_buffer_allocator_t* allocator, fixed_buffer_node_t* node)
+{
+    if (allocator->layout->compact)
+    {
+        return (size_t) (*fixed_buffer_node_compact(node) & FIXED_BUFFER_COMPACT_SIZE_MASK);
+    }
+
+    return node->size;
+}
+
+bool fixed_buffer_node_is_hole(fixed_buffer_allocator_t* allocator, fixed_buffer_node_t* node)
+{
+    if (allocator->layout->compact)
+    {
+        return (*fixed_buffer_node_compact(node) & FIXED_BUFFER_COMPACT_HOLE) != 0;
+    }
+
+    return node->is_hole;
+}
+
+void* fixed_buffer_node_end(fixed_buffer_allocator_t* allocator, fixed_buffer_node_t* node)
+{
+    return (void*) ((char*) fixed_buffer_node_memory(allocator, node) + fixed_buffer_node_size(allocator, node));
+}
+
+/**
+ * Returns the index links stored in the memory of a hole.
+ * @param allocator A fixed buffer allocator
+ * @param node A hole
+ * @return The links of the hole
+ */
+static fixed_buffer_hole_t* fixed_buffer_node_hole(fixed_buffer_allocator_t* allocator, fixed_buffer_node_t* node)
+{
+    return (fixed_buffer_hole_t*) fixed_buffer_node_memory(allocator, node);
+}
+
+/**
+ * Writes the header of a node, tagging it as live and clearing its decommitted flag.
+ *
+ * In the compact layout, a hole also gets a footer holding its size, and the flag telling if the previous node is a
+ * hole is kept.  The node following this one must be linked again with `fixed_buffer_node_link/3` if this node changed
+ * from used to hole or the other way around.
+ * @param allocator A fixed buffer allocator
+ * @param node A node
+ * @param size The size of the memory following the node
+ * @param is_hole Indicates if the node is a hole
+ */
+static void fixed_buffer_node_write(fixed_buffer_allocator_t* allocator, fixed_buffer_node_t* node, size_t size, bool is_hole)
+{
+    if (allocator->layout->compact)
+    {
+        uint64_t* header = fixed_buffer_node_compact(node);
+        *header = (FIXED_BUFFER_COMPACT_MAGIC << FIXED_BUFFER_COMPACT_MAGIC_SHIFT)
+            | (uint64_t) size
+            | (is_hole ? FIXED_BUFFER_COMPACT_HOLE : 0)
+            | (*header & FIXED_BUFFER_COMPACT_PREVIOUS_HOLE);
+
+        if (is_hole)
+        {
+            ((uint64_t*) fixed_buffer_node_end(allocator, node))[-1] = (uint64_t) size;
+        }
+    }
+    else
+    {
+        node->is_hole = is_hole;
+        node->is_decommitted = false;
+        node->magic = FIXED_BUFFER_NODE_MAGIC;
+        node->size = size;
+    }
+}
+
+/**
+ * Indicates if the pages inside a hole were given back to the system.  Any write to the header of the node clears it, so
+ * it must be set again on what is left of a hole after part of it is reserved.
+ * @param allocator A fixed buffer allocator
+ * @param node A hole
+ * @return If the hole is decommitted
+ */
+static bool fixed_buffer_node_is_decommitted(fixed_buffer_allocator_t* allocator, fixed_buffer_node_t* node)
+{
+    if (allocator->layout->compact)
+    {
+        return (*fixed_buffer_node_compact(node) & FIXED_BUFFER_COMPACT_DECOMMITTED) != 0;
+    }
+
+    return node->is_decommitted;
+}
+
+/**
+ * Sets or clears the flag telling if the pages inside a hole were given back to the system.
+ * @param allocator A fixed buffer allocator
+ * @param node A hole
+ * @param is_decommitted Indicates if the hole is decommitted
+ */
+static void fixed_buffer_node_set_decommitted(fixed_buffer_allocator_t* allocator, fixed_buffer_node_t* node, bool is_decommitted)
+{
+    if (allocator->layout->compact)
+    {
+        uint64_t* header = fixed_buffer_node_compact(node);
+        *header = is_decommitted ? *header | FIXED_BUFFER_COMPACT_DECOMMITTED : *header & ~FIXED_BUFFER_COMPACT_DECOMMITTED;
+    }
+    else
+    {
+        node->is_decommitted = is_decommitted;
+    }
+}
+
+/**
+ * Records that a node is preceded by another one in memory.
+ *
+ * In the standard layout, this is a pointer to the previous node.  In the compact layout, only whether the previous node
+ * is a hole is recorded, since the footer of a hole is enough to find it.
+ * @param allocator A fixed buffer allocator
+ * @param previous The node preceding `node`, or `NULL` if `node` is the first node
+ * @param node A node
+ */
+static void fixed_buffer_node_link(fixed_buffer_allocator_t* allocator, fixed_buffer_node_t* previous, fixed_buffer_node_t* node)
+{
+    if (allocator->layout->compact)
+    {
+        uint64_t* header = fixed_buffer_node_compact(node);
+
+        if (previous != NULL && fixed_buffer_node_is_hole(allocator, previous))
+        {
+            *header |= FIXED_BUFFER_COMPACT_PREVIOUS_HOLE;
+        }
+        else
+        {
+            *header &= ~FIXED_BUFFER_COMPACT_PREVIOUS_HOLE;
+        }
+    }
+    else
+    {
+        node->previous = previous;
+    }
+}
+
+/**
+ * Clears the tag of a node header that has been absorbed by a neighboring node.
+ * @param allocator A fixed buffer allocator
+ * @param node A node
+ */
+static void fixed_buffer_node_clear(fixed_buffer_allocator_t* allocator, fixed_buffer_node_t* node)
+{
+    if (allocator->layout->compact)
+    {
+        *fixed_buffer_node_compact(node) = 0;
+    }
+    else
+    {
+        node->magic = 0;
+    }
+}
+
+/**
+ * Indicates if a node header carries the tag of a live node.
+ * @param allocator A fixed buffer allocator
+ * @param node A node
+ * @return If the node is tagged
+ */
+static bool fixed_buffer_node_is_tagged(fixed_buffer_allocator_t* allocator, fixed_buffer_node_t* node)
+{
+    if (allocator->layout->compact)
+    {
+        return (*fixed_buffer_node_compact(node) >> FIXED_BUFFER_COMPACT_MAGIC_SHIFT) == FIXED_BUFFER_COMPACT_MAGIC;
+    }
+
+    return node->magic == FIXED_BUFFER_NODE_MAGIC;
+}
+
+/**
+ * Returns the node preceding another one in memory if it is a hole.
+ * @param allocator A fixed buffer allocator
+ * @param node A node
+ * @return The previous node, or `NULL` if there is none or if it is used
+ */
+static fixed_buffer_node_t* fixed_buffer_node_previous_hole(fixed_buffer_allocator_t* allocator, fixed_buffer_node_t* node)
+{
+    if (allocator->layout->compact)
+    {
+        if ((*fixed_buffer_node_compact(node) & FIXED_BUFFER_COMPACT_PREVIOUS_HOLE) == 0)
+        {
+            return NULL;
+        }
+
+        // The footer of the previous hole holds its size, which leads back to its header.
+        size_t size = (size_t) ((uint64_t*) node)[-1];
+
+        return (fixed_buffer_node_t*) ((char*) node - size - allocator->layout->header_size);
+    }
+
+    fixed_buffer_node_t* previous = node->previous;
+
+    return previous != NULL && previous->is_hole ? previous : NULL;
+}
+
+/**
+ * Rounds a requested size up so that the following node header stays aligned and so that the memory can hold the links
+ * of a hole once it is released.
+ * @param allocator A fixed buffer allocator
+ * @param size A size in bytes
+ * @return The size that will be reserved
+ */
+static size_t fixed_buffer_size_align(fixed_buffer_allocator_t* allocator, size_t size)
+{
+    if (size < allocator->layout->min_size)
+    {
+        return allocator->layout->min_size;
+    }
+
+    return (size + FIXED_BUFFER_ALIGNMENT - 1) & ~(FIXED_BUFFER_ALIGNMENT - 1);
+}
+
+fixed_buffer_node_t* fixed_buffer_node_first(fixed_buffer_allocator_t* allocator)
+{
+    return ((fixed_buffer_node_t*) allocator->buffer);
+}
+
+fixed_buffer_node_t* fixed_buffer_node_next(fixed_buffer_allocator_t* allocator, fixed_buffer_node_t* node)
+{
+    fixed_buffer_node_t* next = (fixed_buffer_node_t*) fixed_buffer_node_end(allocator, node);
+
+    // Ensures that the next node is still in the buffer owned by our allocator.
+    if (((void*) next) < allocator->buffer || ((char*) next) >= ((char*) allocator->buffer) + allocator->size - allocator->layout->header_size)
+    {
+        return NULL;
+    }
+
+    return next;
+}
+
+fixed_buffer_node_t* fixed_buffer_node_peek(fixed_buffer_allocator_t* allocator, void* memory)
+{
+    char* begin = (char*) allocator->buffer;
+    char* end = begin + allocator->size;
+    size_t header_size = allocator->layout->header_size;
+
+    // The header sits right before the memory, so it must be entirely contained in the buffer, and headers are aligned.
+    if ((char*) memory < begin + header_size || (char*) memory >= end || ((size_t) ((char*) memory - begin) & (FIXED_BUFFER_ALIGNMENT - 1)) != 0)
+    {
+        return NULL;
+    }
+
+    fixed_buffer_node_t* node = (fixed_buffer_node_t*) ((char*) memory - header_size);
+
+    if (!fixed_buffer_node_is_tagged(allocator, node) || fixed_buffer_node_is_hole(allocator, node) || (char*) fixed_buffer_node_end(allocator, node) > end)
+    {
+        return NULL;
+    }
+
+    return node;
+}
+
+fixed_buffer_node_t* fixed_buffer_node_find(fixed_buffer_allocator_t* allocator, void* memory)
+{
+    fixed_buffer_node_t* node = fixed_buffer_node_peek(allocator, memory);
+
+    if (node == NULL)
+    {
+        return NULL;
+    }
+
+    // A stray tag inside user data is very unlikely to also be linked to valid neighboring nodes.
+    if (allocator->layout->compact)
+    {
+        fixed_buffer_node_t* next = fixed_buffer_node_next(allocator, node);
+
+        if (next != NULL && (!fixed_buffer_node_is_tagged(allocator, next) || (*fixed_buffer_node_compact(next) & FIXED_BUFFER_COMPACT_PREVIOUS_HOLE) != 0))
+        {
+            return NULL;
+        }
+
+        return node;
+    }
+
+    if (node->previous == NULL)
+    {
+        return node == fixed_buffer_node_first(allocator) ? node : NULL;
+    }
+
+    if ((void*) node->previous < allocator->buffer || node->previous >= node || fixed_buffer_node_end(allocator, node->previous) != node)
+    {
+        return NULL;
+    }
+
+    return node;
+}
+
+/**
+ * The operations used by a strategy to keep track of the holes of an allocator.
+ *
+ * Every hole of the buffer is part of the index of the current strategy.  The index is free to choose how holes are
+ * ordered, but it can only store its links in the memory of the holes, as described by `fixed_buffer_hole_t`.
+ */
+typedef struct fixed_buffer_index {
+    /**
+     * Empties the index.
+     */
+    void (*clear_fn)(fixed_buffer_allocator_t* allocator);
+    /**
+     * Adds a hole to the index.
+     */
+    void (*insert_fn)(fixed_buffer_allocator_t* allocator, fixed_buffer_node_t* node);
+    /**
+     * Adds a hole to the index when holes are added in address order, given the hole added before it or `NULL`.
+     */
+    void (*append_fn)(fixed_buffer_allocator_t* allocator, fixed_buffer_node_t* previous, fixed_buffer_node_t* node);
+    /**
+     * Removes a hole from the index.  The size of the hole must not have changed since its insertion.
+     */
+    void (*remove_fn)(fixed_buffer_allocator_t* allocator, fixed_buffer_node_t* node);
+    /**
+     * Replaces a hole from the index by a new hole adjacent to it in memory.  The size of the new hole must be set.
+     */
+    void (*replace_fn)(fixed_buffer_allocator_t* allocator, fixed_buffer_node_t* node, fixed_buffer_node_t* replacement);
+    /**
+     * Changes the size of a hole in the index.
+     */
+    void (*resize_fn)(fixed_buffer_allocator_t* allocator, fixed_buffer_node_t* node, size_t size);
+    /**
+     * Returns the largest hole of the index.
+     */
+    fixed_buffer_node_t* (*largest_fn)(fixed_buffer_allocator_t* allocator);
+    /**
+     * Returns the first hole of the index.
+     */
+    fixed_buffer_node_t* (*first_fn)(fixed_buffer_allocator_t* allocator);
+    /**
+     * Returns the hole following another hole in the index.
+     */
+    fixed_buffer_node_t* (*next_fn)(fixed_buffer_allocator_t* allocator, fixed_buffer_node_t* node);
+} fixed_buffer_index_t;
+
+struct fixed_buffer_strategy {
+    allocator_t allocator;
+    /**
+     * The index in which the strategy keeps the holes.
+     */
+    const fixed_buffer_index_t* index;
+    /**
+     * Returns a hole of at least the given size, or `NULL` if none is available.
+     */
+    fixed_buffer_node_t* (*find_hole_fn)(fixed_buffer_allocator_t* allocator, size_t size);
+};
+
+fixed_buffer_node_t* fixed_buffer_hole_first(fixed_buffer_allocator_t* allocator)
+{
+    return allocator->strategy->index->first_fn(allocator);
+}
+
+fixed_buffer_node_t* fixed_buffer_hole_next(fixed_buffer_allocator_t* allocator, fixed_buffer_node_t* node)
+{
+    return allocator->strategy->index->next_fn(allocator, node);
+}
+
+fixed_buffer_node_t* fixed_buffer_hole_largest(fixed_buffer_allocator_t* allocator)
+{
+    return allocator->strategy->index->largest_fn(allocator);
+}
+
+static void free_list_clear(fixed_buffer_allocator_t* allocator)
+{
+    allocator->holes.list.first = NULL;
+    allocator->holes.list.rover = NULL;
+}
+
+/**
+ * Links a hole in the free list right after another hole.
+ * @param allocator A fixed buffer allocator
+ * @param previous The hole preceding `node` in memory, or `NULL` to make `node` the first hole
+ * @param node A hole that is not in the free list
+ */
+static void free_list_insert_after(fixed_buffer_allocator_t* allocator, fixed_buffer_node_t* previous, fixed_buffer_node_t* node)
+{
+    fixed_buffer_hole_t* hole = fixed_buffer_node_hole(allocator, node);
+    hole->previous = previous;
+
+    if (previous == NULL)
+    {
+        hole->next = allocator->holes.list.first;
+        allocator->holes.list.first = node;
+    }
+    else
+    {
+        hole->next = fixed_buffer_node_hole(allocator, previous)->next;
+        fixed_buffer_node_hole(allocator, previous)->next = node;
+    }
+
+    if (hole->next != NULL)
+    {
+        fixed_buffer_node_hole(allocator, hole->next)->previous = node;
+    }
+}
+
+/**
+ * Links a hole in the free list, keeping the free list sorted by address.
+ *
+ * This is the only free list operation that is not constant time, since the position of the hole must be searched for
+ * when none of its neighbors in memory are holes.
+ * @param allocator A fixed buffer allocator
+ * @param node A hole that is not in the free list
+ */
+static void free_list_insert(fixed_buffer_allocator_t* allocator, fixed_buffer_node_t* node)
+{
+    fixed_buffer_node_t* previous = NULL;
+    fixed_buffer_node_t* hole = allocator->holes.list.first;
+
+    while (hole != NULL && hole < node)
+    {
+        previous = hole;
+        hole = fixed_buffer_node_hole(allocator, hole)->next;
+    }
+
+    free_list_insert_after(allocator, previous, node);
+}
+
+static void free_list_remove(fixed_buffer_allocator_t* allocator, fixed_buffer_node_t* node)
+{
+    fixed_buffer_hole_t* hole = fixed_buffer_node_hole(allocator, node);
+
+    if (hole->previous == NULL)
+    {
+        allocator->holes.list.first = hole->next;
+    }
+    else
+    {
+        fixed_buffer_node_hole(allocator, hole->previous)->next = hole->next;
+    }
+
+    if (hole->next != NULL)
+    {
+        fixed_buffer_node_hole(allocator, hole->next)->previous = hole->previous;
+    }
+
+    // Next fit resumes its search right after the hole that disappeared.
+    if (allocator->holes.list.rover == node)
+    {
+        allocator->holes.list.rover = hole->next;
+    }
+}
+
+static void free_list_replace(fixed_buffer_allocator_t* allocator, fixed_buffer_node_t* node, fixed_buffer_node_t* replacement)
+{
+    fixed_buffer_hole_t links = *fixed_buffer_node_hole(allocator, node);
+    *fixed_buffer_node_hole(allocator, replacement) = links;
+
+    if (links.previous == NULL)
+    {
+        allocator->holes.list.first = replacement;
+    }
+    else
+    {
+        fixed_buffer_node_hole(allocator, links.previous)->next = replacement;
+    }
+
+    if (links.next != NULL)
+    {
+        fixed_buffer_node_hole(allocator, links.next)->previous = replacement;
+    }
+
+    if (allocator->holes.list.rover == node)
+    {
+        allocator->holes.list.rover = replacement;
+    }
+}
+
+static void free_list_resize(fixed_buffer_allocator_t* allocator, fixed_buffer_node_t* node, size_t size)
+{
+    // The free list is sorted by address, so a hole growing in place keeps its position.
+    fixed_buffer_node_write(allocator, node, size, true);
+}
+
+static fixed_buffer_node_t* free_list_largest(fixed_buffer_allocator_t* allocator)
+{
+    fixed_buffer_node_t* largest = NULL;
+
+    for (fixed_buffer_node_t* node = allocator->holes.list.first; node != NULL; node = fixed_buffer_node_hole(allocator, node)->next)
+    {
+        if (largest == NULL || fixed_buffer_node_size(allocator, node) > fixed_buffer_node_size(allocator, largest))
+        {
+            largest = node;
+        }
+    }
+
+    return largest;
+}
+
+static fixed_buffer_node_t* free_list_first(fixed_buffer_allocator_t* allocator)
+{
+    return allocator->holes.list.first;
+}
+
+static fixed_buffer_node_t* free_list_next(fixed_buffer_allocator_t* allocator, fixed_buffer_node_t* node)
+{
+    return fixed_buffer_node_hole(allocator, node)->next;
+}
+
+/**
+ * A doubly linked list of holes sorted by address.
+ */
+static const fixed_buffer_index_t free_list_index = {
+    .clear_fn = free_list_clear,
+    .insert_fn = free_list_insert,
+    .append_fn = free_list_insert_after,
+    .remove_fn = free_list_remove,
+    .replace_fn = free_list_replace,
+    .resize_fn = free_list_resize,
+    .largest_fn = free_list_largest,
+    .first_fn = free_list_first,
+    .next_fn = free_list_next,
+};
+
+/**
+ * Orders holes by size, and then by address so that every hole has a distinct position in the tree.
+ * @param allocator A fixed buffer allocator
+ * @param node A hole
+ * @param other Another hole
+ * @return If `node` comes before `other`
+ */
+static bool tree_less(fixed_buffer_allocator_t* allocator, fixed_buffer_node_t* node, fixed_buffer_node_t* other)
+{
+    size_t size = fixed_buffer_node_size(allocator, node);
+    size_t other_size = fixed_buffer_node_size(allocator, other);
+
+    return size < other_size || (size == other_size && node < other);
+}
+
+/**
+ * Computes the heap priority of a hole in the treap by hashing its address, so that it needs no storage.
+ * @param node A hole
+ * @return A priority
+ */
+static uint32_t tree_priority(fixed_buffer_node_t* node)
+{
+    uint64_t x = (uint64_t) (uintptr_t) node;
+    x ^= x >> 33;
+    x *= UINT64_C(0xFF51AFD7ED558CCD);
+    x ^= x >> 33;
+
+    return (uint32_t) x;
+}
+
+/**
+ * Splits a subtree into the holes ordered before a hole, and the holes ordered after it.
+ * @param allocator A fixed buffer allocator
+ * @param node The root of a subtree
+ * @param key A hole that is not in the subtree
+ * @param left Where to link the holes ordered before `key`
+ * @param right Where to link the holes ordered after `key`
+ */
+static void tree_split(fixed_buffer_allocator_t* allocator, fixed_buffer_node_t* node, fixed_buffer_node_t* key, fixed_buffer_node_t** left, fixed_buffer_node_t** right)
+{
+    while (node != NULL)
+    {
+        if (tree_less(allocator, node, key))
+        {
+            *left = node;
+            left = &fixed_buffer_node_hole(allocator, node)->right;
+            node = *left;
+        }
+        else
+        {
+            *right = node;
+            right = &fixed_buffer_node_hole(allocator, node)->left;
+            node = *right;
+        }
+    }
+
+    *left = NULL;
+    *right = NULL;
+}
+
+/**
+ * Merges two subtrees, where all the holes of the first one are ordered before the holes of the second one.
+ * @param allocator A fixed buffer allocator
+ * @param left The root of a subtree
+ * @param right The root of a subtree
+ * @return The root of the merged subtree
+ */
+static fixed_buffer_node_t* tree_merge(fixed_buffer_allocator_t* allocator, fixed_buffer_node_t* left, fixed_buffer_node_t* right)
+{
+    fixed_buffer_node_t* root = NULL;
+    fixed_buffer_node_t** link = &root;
+
+    while (left != NULL && right != NULL)
+    {
+        if (tree_priority(left) > tree_priority(right))
+        {
+            *link = left;
+            link = &fixed_buffer_node_hole(allocator, left)->right;
+            left = *link;
+        }
+        else
+        {
+            *link = right;
+            link = &fixed_buffer_node_hole(allocator, right)->left;
+            right = *link;
+        }
+    }
+
+    *link = left != NULL ? left : right;
+
+    return root;
+}
+
+static void tree_clear(fixed_buffer_allocator_t* allocator)
+{
+    allocator->holes.tree.root = NULL;
+}
+
+static void tree_insert(fixed_buffer_allocator_t* allocator, fixed_buffer_node_t* node)
+{
+    uint32_t priority = tree_priority(node);
+    fixed_buffer_node_t** link = &allocator->holes.tree.root;
+
+    // Descend until the hole has a higher priority than the subtree, which it then splits.
+    while (*link != NULL && tree_priority(*link) >= priority)
+    {
+        link = tree_less(allocator, node, *link) ? &fixed_buffer_node_hole(allocator, *link)->left : &fixed_buffer_node_hole(allocator, *link)->right;
+    }
+
+    tree_split(allocator, *link, node, &fixed_buffer_node_hole(allocator, node)->left, &fixed_buffer_node_hole(allocator, node)->right);
+    *link = node;
+}
+
+static void tree_append(fixed_buffer_allocator_t* allocator, fixed_buffer_node_t* previous, fixed_buffer_node_t* node)
+{
+    UNUSED(previous);
+
+    tree_insert(allocator, node);
+}
+
+static void tree_remove(fixed_buffer_allocator_t* allocator, fixed_buffer_node_t* node)
+{
+    fixed_buffer_node_t** link = &allocator->holes.tree.root;
+
+    while (*link != node)
+    {
+        assert(*link != NULL);
+
+        link = tree_less(allocator, node, *link) ? &fixed_buffer_node_hole(allocator, *link)->left : &fixed_buffer_node_hole(allocator, *link)->right;
+    }
+
+    *link = tree_merge(allocator, fixed_buffer_node_hole(allocator, node)->left, fixed_buffer_node_hole(allocator, node)->right);
+}
+
+static void tree_replace(fixed_buffer_allocator_t* allocator, fixed_buffer_node_t* node, fixed_buffer_node_t* replacement)
+{
+    tree_remove(allocator, node);
+    tree_insert(allocator, replacement);
+}
+
+static void tree_resize(fixed_buffer_allocator_t* allocator, fixed_buffer_node_t* node, size_t size)
+{
+    tree_remove(allocator, node);
+    fixed_buffer_node_write(allocator, node, size, true);
+    tree_insert(allocator, node);
+}
+
+/**
+ * Returns the first hole, in the order of the tree, of at least the given size.
+ * @param allocator A fixed buffer allocator
+ * @param size A size in bytes
+ * @return A hole, or `NULL`
+ */
+static fixed_buffer_node_t* tree_lower_bound(fixed_buffer_allocator_t* allocator, size_t size)
+{
+    fixed_buffer_node_t* lower_bound = NULL;
+    fixed_buffer_node_t* node = allocator->holes.tree.root;
+
+    while (node != NULL)
+    {
+        if (fixed_buffer_node_size(allocator, node) >= size)
+        {
+            lower_bound = node;
+            node = fixed_buffer_node_hole(allocator, node)->left;
+        }
+        else
+        {
+            node = fixed_buffer_node_hole(allocator, node)->right;
+        }
+    }
+
+    return lower_bound;
+}
+
+static fixed_buffer_node_t* tree_largest(fixed_buffer_allocator_t* allocator)
+{
+    fixed_buffer_node_t* node = allocator->holes.tree.root;
+
+    while (node != NULL && fixed_buffer_node_hole(allocator, node)->right != NULL)
+    {
+        node = fixed_buffer_node_hole(allocator, node)->right;
+    }
+
+    return node;
+}
+
+static fixed_buffer_node_t* tree_first(fixed_buffer_allocator_t* allocator)
+{
+    return tree_lower_bound(allocator, 0);
+}
+
+static fixed_buffer_node_t* tree_next(fixed_buffer_allocator_t* allocator, fixed_buffer_node_t* node)
+{
+    fixed_buffer_node_t* next = NULL;
+    fixed_buffer_node_t* subtree = allocator->holes.tree.root;
+
+    // Without parent links, the successor is the last node from which the search for `node` went left.
+    while (subtree != NULL)
+    {
+        if (tree_less(allocator, node, subtree))
+        {
+            next = subtree;
+            subtree = fixed_buffer_node_hole(allocator, subtree)->left;
+        }
+        else
+        {
+            subtree = fixed_buffer_node_hole(allocator, subtree)->right;
+        }
+    }
+
+    return next;
+}
+
+/**
+ * A treap of holes ordered by size, with heap priorities derived from the addresses of the holes.
+ */
+static const fixed_buffer_index_t tree_index = {
+    .clear_fn = tree_clear,
+    .insert_fn = tree_insert,
+    .append_fn = tree_append,
+    .remove_fn = tree_remove,
+    .replace_fn = tree_replace,
+    .resize_fn = tree_resize,
+    .largest_fn = tree_largest,
+    .first_fn = tree_first,
+    .next_fn = tree_next,
+};
+
+/**
+ * The number of bits in the first-level index used for sizes below which size classes are linear.
+ */
+#define TLSF_FL_SHIFT (FIXED_BUFFER_TLSF_SL_LOG2 + 3)
+
+/**
+ * Returns the index of the least significant bit set.
+ * @param bits A non-zero bitmap
+ * @return A bit index
+ */
+static unsigned tlsf_ffs(uint32_t bits)
+{
+    assert(bits != 0);
+
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, bits);
+    return (unsigned) index;
+#else
+    return (unsigned) __builtin_ctz(bits);
+#endif
+}
+
+/**
+ * Returns the index of the most significant bit set.
+ * @param size A non-zero size
+ * @return A bit index
+ */
+static unsigned tlsf_fls(size_t size)
+{
+    assert(size != 0);
+
+#if defined(_MSC_VER) && defined(_WIN64)
+    unsigned long index;
+    _BitScanReverse64(&index, size);
+    return (unsigned) index;
+#elif defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse(&index, size);
+    return (unsigned) index;
+#else
+    return (unsigned) (sizeof(unsigned long long) * 8 - 1 - __builtin_clzll(size));
+#endif
+}
+
+/**
+ * Computes the size class of a hole.  Holes too large for the first-level index are all kept in the last class.
+ * @param size A size in bytes
+ * @param fl The first-level index
+ * @param sl The second-level index
+ */
+static void tlsf_mapping(size_t size, unsigned* fl, unsigned* sl)
+{
+    if (size < ((size_t) 1 << TLSF_FL_SHIFT))
+    {
+        // Small sizes are split linearly in steps of the header alignment.
+        *fl = 0;
+        *sl = (unsigned) (size / (((size_t) 1 << TLSF_FL_SHIFT) / FIXED_BUFFER_TLSF_SL_COUNT));
+        return;
+    }
+
+    unsigned msb = tlsf_fls(size);
+
+    if (msb - TLSF_FL_SHIFT + 1 >= FIXED_BUFFER_TLSF_FL_COUNT)
+    {
+        *fl = FIXED_BUFFER_TLSF_FL_COUNT - 1;
+        *sl = FIXED_BUFFER_TLSF_SL_COUNT - 1;
+        return;
+    }
+
+    *fl = msb - TLSF_FL_SHIFT + 1;
+    *sl = (unsigned) (size >> (msb - FIXED_BUFFER_TLSF_SL_LOG2)) ^ FIXED_BUFFER_TLSF_SL_COUNT;
+}
+
+static void tlsf_clear(fixed_buffer_allocator_t* allocator)
+{
+    memset(&allocator->holes.tlsf, 0, sizeof(allocator->holes.tlsf));
+}
+
+static void tlsf_insert(fixed_buffer_allocator_t* allocator, fixed_buffer_node_t* node)
+{
+    unsigned fl, sl;
+    tlsf_mapping(fixed_buffer_node_size(allocator, node), &fl, &sl);
+
+    fixed_buffer_hole_t* hole = fixed_buffer_node_hole(allocator, node);
+    hole->previous = NULL;
+    hole->next = allocator->holes.tlsf.heads[fl][sl];
+
+    if (hole->next != NULL)
+    {
+        fixed_buffer_node_hole(allocator, hole->next)->previous = node;
+    }
+
+    allocator->holes.tlsf.heads[fl][sl] = node;
+    allocator->holes.tlsf.fl_bitmap |= UINT32_C(1) << fl;
+    allocator->holes.tlsf.sl_bitmap[fl] |= UINT32_C(1) << sl;
+}
+
+static void tlsf_append(fixed_buffer_allocator_t* allocator, fixed_buffer_node_t* previous, fixed_buffer_node_t* node)
+{
+    UNUSED(previous);
+
+    tlsf_insert(allocator, node);
+}
+
+static void tlsf_remove(fixed_buffer_allocator_t* allocator, fixed_buffer_node_t* node)
 {
-    return (void*) (node + 1);
+    unsigned fl, sl;
+    tlsf_mapping(fixed_buffer_node_size(allocator, node), &fl, &sl);
+
+    fixed_buffer_hole_t* hole = fixed_buffer_node_hole(allocator, node);
+
+    if (hole->next != NULL)
+    {
+        fixed_buffer_node_hole(allocator, hole->next)->previous = hole->previous;
+    }
+
+    if (hole->previous != NULL)
+    {
+        fixed_buffer_node_hole(allocator, hole->previous)->next = hole->next;
+        return;
+    }
+
+    allocator->holes.tlsf.heads[fl][sl] = hole->next;
+
+    // The list is now empty, so the bitmaps must stop pointing to it.
+    if (hole->next == NULL)
+    {
+        allocator->holes.tlsf.sl_bitmap[fl] &= ~(UINT32_C(1) << sl);
+
+        if (allocator->holes.tlsf.sl_bitmap[fl] == 0)
+        {
+            allocator->holes.tlsf.fl_bitmap &= ~(UINT32_C(1) << fl);
+        }
+    }
 }
 
-void* fixed_buffer_node_end(fixed_buffer_node_t* node)
+static void tlsf_replace(fixed_buffer_allocator_t* allocator, fixed_buffer_node_t* node, fixed_buffer_node_t* replacement)
 {
-    return (void*) ((char*) (node + 1) + node->size);
+    tlsf_remove(allocator, node);
+    tlsf_insert(allocator, replacement);
 }
 
-fixed_buffer_node_t* fixed_buffer_node_first(fixed_buffer_allocator_t* allocator)
+static void tlsf_resize(fixed_buffer_allocator_t* allocator, fixed_buffer_node_t* node, size_t size)
 {
-    return ((fixed_buffer_node_t*) allocator->buffer);
+    tlsf_remove(allocator, node);
+    fixed_buffer_node_write(allocator, node, size, true);
+    tlsf_insert(allocator, node);
 }
 
-fixed_buffer_node_t* fixed_buffer_node_next(fixed_buffer_allocator_t* allocator, fixed_buffer_node_t* node)
+/**
+ * Returns the head of the first non-empty list of a size class greater than or equal to the given one.
+ * @param allocator A fixed buffer allocator
+ * @param fl The first-level index
+ * @param sl The second-level index
+ * @return A hole, or `NULL`
+ */
+static fixed_buffer_node_t* tlsf_search(fixed_buffer_allocator_t* allocator, unsigned fl, unsigned sl)
 {
-    fixed_buffer_node_t* next = (fixed_buffer_node_t*) fixed_buffer_node_end(node);
+    uint32_t sl_map = sl < FIXED_BUFFER_TLSF_SL_COUNT ? allocator->holes.tlsf.sl_bitmap[fl] & (~UINT32_C(0) << sl) : 0;
 
-    // Ensures that the next node is still in the buffer owned by our allocator.
-    if (((void*) next) < allocator->buffer || ((char*) next) >= ((char*) allocator->buffer) + allocator->size - sizeof(fixed_buffer_node_t))
+    if (sl_map == 0)
     {
-        return NULL;
+        if (fl + 1 >= FIXED_BUFFER_TLSF_FL_COUNT)
+        {
+            return NULL;
+        }
+
+        uint32_t fl_map = allocator->holes.tlsf.fl_bitmap & (~UINT32_C(0) << (fl + 1));
+
+        if (fl_map == 0)
+        {
+            return NULL;
+        }
+
+        fl = tlsf_ffs(fl_map);
+        sl_map = allocator->holes.tlsf.sl_bitmap[fl];
     }
 
-    return next;
+    return allocator->holes.tlsf.heads[fl][tlsf_ffs(sl_map)];
 }
 
-fixed_buffer_node_t* fixed_buffer_node_find(fixed_buffer_allocator_t* allocator, void* memory)
+static fixed_buffer_node_t* tlsf_largest(fixed_buffer_allocator_t* allocator)
 {
-    fixed_buffer_node_t* node = fixed_buffer_node_first(allocator);
+    if (allocator->holes.tlsf.fl_bitmap == 0)
+    {
+        return NULL;
+    }
 
-    while (node != NULL)
+    unsigned fl = tlsf_fls(allocator->holes.tlsf.fl_bitmap);
+    unsigned sl = tlsf_fls(allocator->holes.tlsf.sl_bitmap[fl]);
+
+    // Only the list of the largest size class needs to be searched.  This walk is deliberately not constant: the largest
+    // hole is a statistic, never looked up to allocate, and the heads of a class are not sorted by size.
+    fixed_buffer_node_t* largest = allocator->holes.tlsf.heads[fl][sl];
+
+    for (fixed_buffer_node_t* node = largest; node != NULL; node = fixed_buffer_node_hole(allocator, node)->next)
     {
-        // TODO(Alexis Brodeur): Consider allowing one to find a node when the memory is a pointer in the memory owned
-        // by a node, and not only the start of the node's memory.
-        if (memory == fixed_buffer_node_memory(node))
+        if (fixed_buffer_node_size(allocator, node) > fixed_buffer_node_size(allocator, largest))
         {
-            break;
+            largest = node;
         }
+    }
+
+    return largest;
+}
+
+static fixed_buffer_node_t* tlsf_first(fixed_buffer_allocator_t* allocator)
+{
+    return tlsf_search(allocator, 0, 0);
+}
+
+static fixed_buffer_node_t* tlsf_next(fixed_buffer_allocator_t* allocator, fixed_buffer_node_t* node)
+{
+    fixed_buffer_node_t* next = fixed_buffer_node_hole(allocator, node)->next;
 
-        node = fixed_buffer_node_next(allocator,  node);
+    if (next != NULL)
+    {
+        return next;
     }
 
-    return node;
+    unsigned fl, sl;
+    tlsf_mapping(fixed_buffer_node_size(allocator, node), &fl, &sl);
+
+    return tlsf_search(allocator, fl, sl + 1);
 }
 
 /**
- * Reserves a node in the list, ensuring that the doubly linked list of nodes is kept valid.
+ * Segregated lists of holes by size class, with bitmaps of the non-empty lists.
+ */
+static const fixed_buffer_index_t tlsf_index = {
+    .clear_fn = tlsf_clear,
+    .insert_fn = tlsf_insert,
+    .append_fn = tlsf_append,
+    .remove_fn = tlsf_remove,
+    .replace_fn = tlsf_replace,
+    .resize_fn = tlsf_resize,
+    .largest_fn = tlsf_largest,
+    .first_fn = tlsf_first,
+    .next_fn = tlsf_next,
+};
+
+/**
+ * Reserves a node in the list, ensuring that the doubly linked list of nodes and the index of holes are kept valid.
  * @param allocator A fixed buffer allocator
- * @param node A node
- * @param size A size
+ * @param node A hole
+ * @param size A size, as returned by `fixed_buffer_size_align/2`
  * @return The memory owned by the reserved node.
  */
 static void* fixed_buffer_node_reserve(fixed_buffer_allocator_t* allocator, fixed_buffer_node_t* node, size_t size)
 {
-    UNUSED(allocator);
-
     assert(node != NULL);
-    assert(node->is_hole);
+    assert(fixed_buffer_node_is_hole(allocator, node));
 
-    size_t remaining_size = node->size - size - sizeof(fixed_buffer_node_t);
+    const fixed_buffer_index_t* index = allocator->strategy->index;
+    size_t header_size = allocator->layout->header_size;
+    size_t node_size = fixed_buffer_node_size(allocator, node);
 
-    // If we were to create a new node after this one, do we have enough bytes left.
+    // If we were to create a new hole after this one, do we have enough bytes left for its header and its links.
     // If not, this node does not change size.
-    if (remaining_size > 0)
+    if (node_size >= size + header_size + allocator->layout->min_size)
     {
-        node->size = size;
-
-        fixed_buffer_node_t* split = (fixed_buffer_node_t*) fixed_buffer_node_end(node);
-        split->is_hole = true;
-        split->size = remaining_size;
-        split->previous = node;
+        // The pages inside the rest of the hole stay decommitted, its header being written before them.
+        bool is_decommitted = fixed_buffer_node_is_decommitted(allocator, node);
+        fixed_buffer_node_t* split = (fixed_buffer_node_t*) ((char*) fixed_buffer_node_memory(allocator, node) + size);
+        fixed_buffer_node_write(allocator, split, node_size - size - header_size, true);
+        fixed_buffer_node_set_decommitted(allocator, split, is_decommitted);
 
         fixed_buffer_node_t* next = fixed_buffer_node_next(allocator, split);
         if (next != NULL)
         {
-            next->previous = split;
+            fixed_buffer_node_link(allocator, split, next);
+        }
+
+        index->replace_fn(allocator, node, split);
+        fixed_buffer_node_write(allocator, node, size, false);
+        fixed_buffer_node_link(allocator, node, split);
+    }
+    else
+    {
+        index->remove_fn(allocator, node);
+        fixed_buffer_node_write(allocator, node, node_size, false);
+
+        fixed_buffer_node_t* next = fixed_buffer_node_next(allocator, node);
+        if (next != NULL)
+        {
+            fixed_buffer_node_link(allocator, node, next);
         }
     }
 
-    node->is_hole = false;
-    allocator->last_node_reserved = node;
+    return fixed_buffer_node_memory(allocator, node);
+}
+
+/**
+ * Gives the whole pages of a range back to the system, their content being lost.  Does nothing on systems without
+ * `madvise`.
+ * @param page_size The size of a page
+ * @param begin The beginning of the range
+ * @param end The end of the range
+ * @return The number of bytes given back
+ */
+static size_t fixed_buffer_decommit(size_t page_size, char* begin, char* end)
+{
+#if defined(__unix__) || defined(__APPLE__)
+    char* first = begin + (size_t) (-(uintptr_t) begin & (page_size - 1));
+    char* last = end - (size_t) ((uintptr_t) end & (page_size - 1));
+
+    if (first >= last || madvise(first, (size_t) (last - first), MADV_DONTNEED) != 0)
+    {
+        return 0;
+    }
+
+    return (size_t) (last - first);
+#else
+    UNUSED(page_size);
+    UNUSED(begin);
+    UNUSED(end);
+
+    return 0;
+#endif
+}
+
+/**
+ * Gives the pages of part of a hole back to the system and flags the hole as decommitted.  The links and the footer of
+ * the hole are kept.
+ * @param allocator A fixed buffer allocator
+ * @param node A hole
+ * @param begin The beginning of the part of the hole to decommit
+ * @param end The end of the part of the hole to decommit
+ * @return The number of bytes given back
+ */
+static size_t fixed_buffer_hole_decommit(fixed_buffer_allocator_t* allocator, fixed_buffer_node_t* node, char* begin, char* end)
+{
+    char* interior = (char*) fixed_buffer_node_memory(allocator, node) + sizeof(fixed_buffer_hole_t);
+    char* limit = (char*) fixed_buffer_node_end(allocator, node) - (allocator->layout->compact ? sizeof(uint64_t) : 0);
 
-    return fixed_buffer_node_memory(node);
+    size_t size = fixed_buffer_decommit(allocator->page_size, begin > interior ? begin : interior, end < limit ? end : limit);
+    fixed_buffer_node_set_decommitted(allocator, node, true);
+
+    return size;
 }
 
 /**
- * Releases the node from use, updating neighboring nodes if the are also holes.
+ * Releases the node from use, updating neighboring nodes and the index of holes if the are also holes.  If the resulting
+ * hole is large enough to be decommitted, the pages it did not already give back are given back to the system.
  * @param allocator A fixed buffer allocator
  * @param node A node to release
  */
 static void fixed_buffer_node_release(fixed_buffer_allocator_t* allocator, fixed_buffer_node_t* node)
 {
     assert(node != NULL);
-    assert(!node->is_hole);
+    assert(!fixed_buffer_node_is_hole(allocator, node));
 
-    fixed_buffer_node_t* previous = node->previous;
+    const fixed_buffer_index_t* index = allocator->strategy->index;
+    size_t header_size = allocator->layout->header_size;
+
+    fixed_buffer_node_t* previous = fixed_buffer_node_previous_hole(allocator, node);
     fixed_buffer_node_t* next = fixed_buffer_node_next(allocator, node);
+    fixed_buffer_node_t* after = next;
 
-    // The previous node is a hole, make `node` a part of `previous` node.
-    if (previous && previous->is_hole)
+    size_t size = fixed_buffer_node_size(allocator, node);
+
+    // Only the released node needs to be decommitted if the holes it merges with already are, along with the pages it
+    // shares with them, which they could not give back while the node was used.
+    char* released = (char*) node;
+    char* released_end = (char*) fixed_buffer_node_end(allocator, node);
+    bool neighbors_decommitted = allocator->decommit_threshold != 0
+        && (previous == NULL || fixed_buffer_node_is_decommitted(allocator, previous))
+        && (next == NULL || !fixed_buffer_node_is_hole(allocator, next) || fixed_buffer_node_is_decommitted(allocator, next));
+
+    if (neighbors_decommitted && previous != NULL)
     {
-        previous->size += node->size + sizeof(fixed_buffer_node_t);
-        node = previous;
+        released -= (uintptr_t) released & (allocator->page_size - 1);
+    }
 
-        if (next != NULL) {
-            next->previous = node;
-        }
+    if (neighbors_decommitted && next != NULL && fixed_buffer_node_is_hole(allocator, next))
+    {
+        released_end = (char*) fixed_buffer_node_memory(allocator, next) + sizeof(fixed_buffer_hole_t);
+        released_end += (size_t) (-(uintptr_t) released_end & (allocator->page_size - 1));
     }
 
-    // The next node is a hole, make it a part of `node`.
-    if (next && next->is_hole)
+    // The next node is a hole, make it a part of the released memory.
+    if (next && fixed_buffer_node_is_hole(allocator, next))
     {
-        fixed_buffer_node_t* after_next = fixed_buffer_node_next(allocator, next);
+        size += fixed_buffer_node_size(allocator, next) + header_size;
+        after = fixed_buffer_node_next(allocator, next);
+    }
+    else
+    {
+        next = NULL;
+    }
 
-        // Update backward references.
-        if (after_next != NULL)
+    // The previous node is a hole, make `node` a part of `previous` node.
+    if (previous != NULL)
+    {
+        if (next != NULL)
         {
-            after_next->previous = node;
+            index->remove_fn(allocator, next);
+            fixed_buffer_node_clear(allocator, next);
         }
 
-        node->size += next->size + sizeof(fixed_buffer_node_t);
+        index->resize_fn(allocator, previous, fixed_buffer_node_size(allocator, previous) + size + header_size);
+        fixed_buffer_node_clear(allocator, node);
+        node = previous;
+    }
+    // The next node is a hole, `node` takes its place in the index.
+    else if (next != NULL)
+    {
+        fixed_buffer_node_write(allocator, node, size, true);
+        index->replace_fn(allocator, next, node);
+        fixed_buffer_node_clear(allocator, next);
+    }
+    // Both neighbors are used.
+    else
+    {
+        fixed_buffer_node_write(allocator, node, size, true);
+        index->insert_fn(allocator, node);
+    }
+
+    // Update backward references.
+    if (after != NULL)
+    {
+        fixed_buffer_node_link(allocator, node, after);
     }
 
-    // Override the tag to ensure that we have a hole in the buffer.
-    node->is_hole = true;
+    if (allocator->decommit_threshold != 0 && fixed_buffer_node_size(allocator, node) >= allocator->decommit_threshold)
+    {
+        if (neighbors_decommitted)
+        {
+            fixed_buffer_hole_decommit(allocator, node, released, released_end);
+        }
+        else
+        {
+            fixed_buffer_hole_decommit(allocator, node, (char*) node, (char*) fixed_buffer_node_end(allocator, node));
+        }
+    }
 }
 
-struct fixed_buffer_strategy {
-    allocator_t allocator;
-};
+/**
+ * Shrinks a used node, giving the memory past the given size back as a hole if it is large enough to hold one.
+ * @param allocator A fixed buffer allocator
+ * @param node A used node
+ * @param size A size, as returned by `fixed_buffer_size_align/2`, smaller than or equal to the size of the node
+ */
+static void fixed_buffer_node_trim(fixed_buffer_allocator_t* allocator, fixed_buffer_node_t* node, size_t size)
+{
+    size_t header_size = allocator->layout->header_size;
+    size_t node_size = fixed_buffer_node_size(allocator, node);
+
+    assert(!fixed_buffer_node_is_hole(allocator, node));
+    assert(size <= node_size);
+
+    if (node_size < size + header_size + allocator->layout->min_size)
+    {
+        return;
+    }
+
+    const fixed_buffer_index_t* index = allocator->strategy->index;
+
+    fixed_buffer_node_t* next = fixed_buffer_node_next(allocator, node);
+    fixed_buffer_node_t* after = next;
+
+    fixed_buffer_node_t* tail = (fixed_buffer_node_t*) ((char*) fixed_buffer_node_memory(allocator, node) + size);
+    size_t tail_size = node_size - size - header_size;
+
+    // The tail ends where the next node begins, so a following hole can be merged into it.
+    if (next && fixed_buffer_node_is_hole(allocator, next))
+    {
+        after = fixed_buffer_node_next(allocator, next);
+        fixed_buffer_node_write(allocator, tail, tail_size + fixed_buffer_node_size(allocator, next) + header_size, true);
+        index->replace_fn(allocator, next, tail);
+        fixed_buffer_node_clear(allocator, next);
+    }
+    else
+    {
+        fixed_buffer_node_write(allocator, tail, tail_size, true);
+        index->insert_fn(allocator, tail);
+    }
+
+    fixed_buffer_node_write(allocator, node, size, false);
+    fixed_buffer_node_link(allocator, node, tail);
+
+    if (after != NULL)
+    {
+        fixed_buffer_node_link(allocator, tail, after);
+    }
+}
 
-static void* first_fit_reallocate(allocator_t* _allocator, void* memory, size_t size)
+/**
+ * Resizes a used node without moving its memory elsewhere, by growing into the following hole, or else into the
+ * preceding hole, in which case the memory is moved down.  Growing always gives back the excess as a hole.
+ * @param allocator A fixed buffer allocator
+ * @param node A used node
+ * @param size A size, as returned by `fixed_buffer_size_align/2`
+ * @param alignment The alignment the memory must keep if it is moved down
+ * @return The memory of the resized node, or `NULL` if neighboring holes are too small
+ */
+static void* fixed_buffer_node_resize(fixed_buffer_allocator_t* allocator, fixed_buffer_node_t* node, size_t size, size_t alignment)
 {
-    fixed_buffer_allocator_t* allocator = FIELD_PARENT_PTR(fixed_buffer_allocator_t, allocator, _allocator);
+    assert(!fixed_buffer_node_is_hole(allocator, node));
 
-    if (memory == NULL && size == 0)
+    size_t header_size = allocator->layout->header_size;
+    size_t node_size = fixed_buffer_node_size(allocator, node);
+
+    if (size <= node_size)
     {
-        return NULL;
+        fixed_buffer_node_trim(allocator, node, size);
+        return fixed_buffer_node_memory(allocator, node);
     }
-    // No memory, but a size given, do memory allocation.
-    else if (memory == NULL)
+
+    const fixed_buffer_index_t* index = allocator->strategy->index;
+
+    fixed_buffer_node_t* previous = fixed_buffer_node_previous_hole(allocator, node);
+    fixed_buffer_node_t* next = fixed_buffer_node_next(allocator, node);
+    fixed_buffer_node_t* after = next;
+
+    size_t available = node_size;
+
+    if (next && fixed_buffer_node_is_hole(allocator, next))
+    {
+        available += fixed_buffer_node_size(allocator, next) + header_size;
+        after = fixed_buffer_node_next(allocator, next);
+    }
+    else
     {
-        fixed_buffer_node_t* node = fixed_buffer_node_first(allocator);
+        next = NULL;
+    }
 
-        while (node)
+    if (available >= size)
+    {
+        if (next != NULL)
         {
-            // We have a hole with enough bytes available.
-            if (node->is_hole && node->size >= size)
-            {
-                break;
-            }
-
-            node = fixed_buffer_node_next(allocator, node);
+            index->remove_fn(allocator, next);
+            fixed_buffer_node_clear(allocator, next);
         }
-
-        // `node_next` returns NULL when traversal of the list finishes.
-        // This check indicates that we have not found a suitable block of memory to allocate.
-        if (node == NULL)
+    }
+    else if (
+        previous != NULL
+        && fixed_buffer_node_size(allocator, previous) + header_size + available >= size
+        && ((uintptr_t) fixed_buffer_node_memory(allocator, previous) & (alignment - 1)) == 0
+    )
+    {
+        if (next != NULL)
         {
-            return NULL;
+            index->remove_fn(allocator, next);
+            fixed_buffer_node_clear(allocator, next);
         }
 
-        // We found a node, so we allocate a size out of it.
-        return fixed_buffer_node_reserve(allocator, node, size);
+        index->remove_fn(allocator, previous);
+        available += fixed_buffer_node_size(allocator, previous) + header_size;
+
+        // The tag is cleared before the header is possibly overwritten by the memory being moved.
+        fixed_buffer_node_clear(allocator, node);
+        memmove(fixed_buffer_node_memory(allocator, previous), fixed_buffer_node_memory(allocator, node), node_size);
+
+        node = previous;
     }
-    // Memory is not null, do a free.
-    else if (size == 0)
+    else
     {
-        fixed_buffer_node_t* node = fixed_buffer_node_find(allocator, memory);
+        return NULL;
+    }
 
-        if (node == NULL)
+    fixed_buffer_node_write(allocator, node, available, false);
+
+    if (after != NULL)
+    {
+        fixed_buffer_node_link(allocator, node, after);
+    }
+
+    fixed_buffer_node_trim(allocator, node, size);
+
+    return fixed_buffer_node_memory(allocator, node);
+}
+
+/**
+ * Returns the number of bytes to skip at the beginning of a hole so that the memory of a node placed after them is
+ * aligned.  Unless there are none, the skipped bytes must be large enough to remain a hole of their own.
+ * @param allocator A fixed buffer allocator
+ * @param node A hole
+ * @param alignment A power of two
+ * @return A size in bytes
+ */
+static size_t fixed_buffer_node_padding(fixed_buffer_allocator_t* allocator, fixed_buffer_node_t* node, size_t alignment)
+{
+    uintptr_t memory = (uintptr_t) fixed_buffer_node_memory(allocator, node);
+    size_t padding = (size_t) (-memory & (alignment - 1));
+    size_t min_padding = allocator->layout->header_size + allocator->layout->min_size;
+
+    if (padding != 0 && padding < min_padding)
+    {
+        padding += (min_padding - padding + alignment - 1) & ~(alignment - 1);
+    }
+
+    return padding;
+}
+
+/**
+ * Finds a hole that can hold `size` bytes of aligned memory once its padding is skipped.
+ * @param allocator A fixed buffer allocator
+ * @param size A size, as returned by `fixed_buffer_size_align/2`
+ * @param alignment A power of two
+ * @return A hole, or `NULL` if none is large enough
+ */
+static fixed_buffer_node_t* fixed_buffer_hole_find_aligned(fixed_buffer_allocator_t* allocator, size_t size, size_t alignment)
+{
+    if (alignment <= FIXED_BUFFER_ALIGNMENT)
+    {
+        return allocator->strategy->find_hole_fn(allocator, size);
+    }
+
+    // A hole with room for the largest possible padding fits wherever it lies, so the strategy can pick it.
+    size_t max_padding = allocator->layout->header_size + allocator->layout->min_size + alignment - FIXED_BUFFER_ALIGNMENT;
+
+    if (size <= allocator->size && max_padding <= allocator->size - size)
+    {
+        fixed_buffer_node_t* node = allocator->strategy->find_hole_fn(allocator, size + max_padding);
+
+        if (node != NULL)
         {
-            return NULL;
+            return node;
         }
+    }
 
-        fixed_buffer_node_release(allocator, node);
+    // Smaller holes may still fit depending on their address.
+    for (fixed_buffer_node_t* node = fixed_buffer_hole_first(allocator); node != NULL; node = fixed_buffer_hole_next(allocator, node))
+    {
+        size_t node_size = fixed_buffer_node_size(allocator, node);
+        size_t padding = fixed_buffer_node_padding(allocator, node, alignment);
 
-        return NULL;
+        if (padding <= node_size && node_size - padding >= size)
+        {
+            return node;
+        }
     }
-    // We have a pointer to memory, and a size, do a resize.
-    else
+
+    return NULL;
+}
+
+/**
+ * Reserves aligned memory in a hole.  The padding in front of the memory is left as a smaller hole.
+ * @param allocator A fixed buffer allocator
+ * @param node A hole, as returned by `fixed_buffer_hole_find_aligned/3`
+ * @param size A size, as returned by `fixed_buffer_size_align/2`
+ * @param alignment A power of two
+ * @return The memory owned by the reserved node.
+ */
+static void* fixed_buffer_node_reserve_aligned(fixed_buffer_allocator_t* allocator, fixed_buffer_node_t* node, size_t size, size_t alignment)
+{
+    size_t padding = fixed_buffer_node_padding(allocator, node, alignment);
+
+    if (padding != 0)
     {
-        fixed_buffer_node_t* node = fixed_buffer_node_find(allocator, memory);
+        const fixed_buffer_index_t* index = allocator->strategy->index;
+        size_t node_size = fixed_buffer_node_size(allocator, node);
 
-        if (node == NULL)
+        fixed_buffer_node_t* next = fixed_buffer_node_next(allocator, node);
+        fixed_buffer_node_t* aligned = (fixed_buffer_node_t*) ((char*) node + padding);
+        bool is_decommitted = fixed_buffer_node_is_decommitted(allocator, node);
+
+        index->resize_fn(allocator, node, padding - allocator->layout->header_size);
+        fixed_buffer_node_set_decommitted(allocator, node, is_decommitted);
+
+        fixed_buffer_node_write(allocator, aligned, node_size - padding, true);
+        fixed_buffer_node_set_decommitted(allocator, aligned, is_decommitted);
+        fixed_buffer_node_link(allocator, node, aligned);
+
+        if (next != NULL)
         {
-            return NULL;
+            fixed_buffer_node_link(allocator, aligned, next);
         }
 
-        if (size <= node->size)
+        index->append_fn(allocator, node, aligned);
+        node = aligned;
+    }
+
+    return fixed_buffer_node_reserve(allocator, node, size);
+}
+
+/**
+ * Reserves as many nodes of the same size as possible in a hole, indexing what is left of the hole once.
+ * @param allocator A fixed buffer allocator
+ * @param node A hole
+ * @param size A size, as returned by `fixed_buffer_size_align/2`, smaller than or equal to the size of the hole
+ * @param count The maximum number of nodes to reserve
+ * @param memories An array receiving the memory owned by each reserved node
+ * @return The number of reserved nodes
+ */
+static size_t fixed_buffer_node_reserve_batch(
+    fixed_buffer_allocator_t* allocator,
+    fixed_buffer_node_t* node,
+    size_t size,
+    size_t count,
+    void** memories
+)
+{
+    size_t header_size = allocator->layout->header_size;
+    size_t node_size = fixed_buffer_node_size(allocator, node);
+    size_t stride = header_size + size;
+
+    // The hole and its header are cut in strides, the last node keeping whatever is left.
+    size_t reserved = (node_size + header_size) / stride;
+
+    if (reserved > count)
+    {
+        reserved = count;
+    }
+
+    if (reserved > 1)
+    {
+        fixed_buffer_node_t* next = fixed_buffer_node_next(allocator, node);
+        fixed_buffer_node_t* last = (fixed_buffer_node_t*) ((char*) node + (reserved - 1) * stride);
+        bool is_decommitted = fixed_buffer_node_is_decommitted(allocator, node);
+
+        // What is left of the hole takes its place in the index before the nodes in front of it are written.
+        fixed_buffer_node_write(allocator, last, node_size - (reserved - 1) * stride, true);
+        fixed_buffer_node_set_decommitted(allocator, last, is_decommitted);
+
+        if (next != NULL)
         {
-            return memory;
+            fixed_buffer_node_link(allocator, last, next);
         }
 
-        void* new_memory = first_fit_reallocate(_allocator, NULL, size);
+        allocator->strategy->index->replace_fn(allocator, node, last);
 
-        if (new_memory == NULL)
+        fixed_buffer_node_t* previous = NULL;
+
+        for (size_t i = 0; i < reserved - 1; ++i)
         {
-            return NULL;
+            fixed_buffer_node_t* current = (fixed_buffer_node_t*) ((char*) node + i * stride);
+            fixed_buffer_node_write(allocator, current, size, false);
+
+            if (previous != NULL)
+            {
+                fixed_buffer_node_link(allocator, previous, current);
+            }
+
+            memories[i] = fixed_buffer_node_memory(allocator, current);
+            previous = current;
         }
 
-        memcpy(new_memory, memory, node->size);
-        fixed_buffer_node_release(allocator, node);
+        fixed_buffer_node_link(allocator, previous, last);
+        node = last;
+    }
+
+    memories[reserved - 1] = fixed_buffer_node_reserve(allocator, node, size);
+
+    return reserved;
+}
+
+/**
+ * Empties the index of the strategy of an allocator and fills it with all the holes of the buffer.
+ * @param allocator A fixed buffer allocator
+ */
+static void fixed_buffer_index_rebuild(fixed_buffer_allocator_t* allocator)
+{
+    const fixed_buffer_index_t* index = allocator->strategy->index;
+
+    index->clear_fn(allocator);
 
-        return new_memory;
+    fixed_buffer_node_t* previous = NULL;
+
+    for (fixed_buffer_node_t* node = fixed_buffer_node_first(allocator); node != NULL; node = fixed_buffer_node_next(allocator, node))
+    {
+        if (fixed_buffer_node_is_hole(allocator, node))
+        {
+            index->append_fn(allocator, previous, node);
+            previous = node;
+        }
     }
 }
 
-static fixed_buffer_strategy_t first_fit_strategy_state = {
-    .allocator = { first_fit_reallocate },
-};
-
-fixed_buffer_strategy_t* FBS_FIRST_FIT = &first_fit_strategy_state;
-
-static void* best_fit_reallocate(allocator_t* _allocator, void* memory, size_t size)
+static void* fixed_buffer_reallocate_aligned(allocator_t* _allocator, void* memory, size_t size, size_t alignment)
 {
     fixed_buffer_allocator_t* allocator = FIELD_PARENT_PTR(fixed_buffer_allocator_t, allocator, _allocator);
 
@@ -232,29 +1674,24 @@ static void* best_fit_reallocate(allocator_t* _allocator, void* memory, size_t s
     // No memory, but a size given, do memory allocation.
     else if (memory == NULL)
     {
-        fixed_buffer_node_t* best_fit = NULL;
-        fixed_buffer_node_t* node = fixed_buffer_node_first(allocator);
-
-        while (node)
+        // This also protects the rounding of the size against overflows.
+        if (size > allocator->size)
         {
-            // We have a hole with enough bytes available.
-            if (node->is_hole && node->size >= size && (best_fit == NULL || node->size < best_fit->size))
-            {
-                best_fit = node;
-            }
-
-            node = fixed_buffer_node_next(allocator, node);
+            return NULL;
         }
 
-        // `node_next` returns NULL when traversal of the list finishes.
+        size = fixed_buffer_size_align(allocator, size);
+
+        fixed_buffer_node_t* node = fixed_buffer_hole_find_aligned(allocator, size, alignment);
+
         // This check indicates that we have not found a suitable block of memory to allocate.
-        if (best_fit == NULL)
+        if (node == NULL)
         {
             return NULL;
         }
 
         // We found a node, so we allocate a size out of it.
-        return fixed_buffer_node_reserve(allocator, best_fit, size);
+        return fixed_buffer_node_reserve_aligned(allocator, node, size, alignment);
     }
     // Memory is not null, do a free.
     else if (size == 0)
@@ -280,249 +1717,522 @@ static void* best_fit_reallocate(allocator_t* _allocator, void* memory, size_t s
             return NULL;
         }
 
-        if (size <= node->size)
+        if (size > allocator->size)
+        {
+            return NULL;
+        }
+
+        size = fixed_buffer_size_align(allocator, size);
+
+        // Copying is only needed when the neighbors of the node cannot absorb the new size, or when the memory was
+        // allocated with a weaker alignment.
+        if (((uintptr_t) memory & (alignment - 1)) == 0)
         {
-            return memory;
+            void* resized_memory = fixed_buffer_node_resize(allocator, node, size, alignment);
+
+            if (resized_memory != NULL)
+            {
+                return resized_memory;
+            }
         }
 
-        void* new_memory = best_fit_reallocate(_allocator, NULL, size);
+        void* new_memory = fixed_buffer_reallocate_aligned(_allocator, NULL, size, alignment);
 
         if (new_memory == NULL)
         {
             return NULL;
         }
 
-        memcpy(new_memory, memory, node->size);
+        size_t node_size = fixed_buffer_node_size(allocator, node);
+
+        memcpy(new_memory, memory, node_size < size ? node_size : size);
         fixed_buffer_node_release(allocator, node);
 
         return new_memory;
     }
 }
 
-static fixed_buffer_strategy_t best_fit_strategy_state = {
-    .allocator = { best_fit_reallocate },
-};
-
-fixed_buffer_strategy_t* FBS_BEST_FIT = &best_fit_strategy_state;
+static void* fixed_buffer_reallocate(allocator_t* allocator, void* memory, size_t size)
+{
+    return fixed_buffer_reallocate_aligned(allocator, memory, size, FIXED_BUFFER_ALIGNMENT);
+}
 
-static void* worst_fit_reallocate(allocator_t* _allocator, void* memory, size_t size)
+static void fixed_buffer_deallocate_sized(allocator_t* _allocator, void* memory, size_t size)
 {
     fixed_buffer_allocator_t* allocator = FIELD_PARENT_PTR(fixed_buffer_allocator_t, allocator, _allocator);
 
-    if (memory == NULL && size == 0)
+    if (memory == NULL)
     {
-        return NULL;
+        return;
     }
-    // No memory, but a size given, do memory allocation.
-    else if (memory == NULL)
-    {
-        fixed_buffer_node_t* worst_fit = NULL;
-        fixed_buffer_node_t* node = fixed_buffer_node_first(allocator);
 
-        while (node)
-        {
-            // We have a hole with enough bytes available.
-            if (node->is_hole && node->size >= size && (worst_fit == NULL || node->size > worst_fit->size))
-            {
-                worst_fit = node;
-            }
+    // The caller vouches for the memory, so the header in front of it is trusted without being validated, except in
+    // debug builds where the size is also checked against it.
+    fixed_buffer_node_t* node = (fixed_buffer_node_t*) ((char*) memory - allocator->layout->header_size);
 
-            node = fixed_buffer_node_next(allocator, node);
-        }
+    assert(fixed_buffer_node_find(allocator, memory) == node);
+    assert(size <= allocator->size && fixed_buffer_size_align(allocator, size) <= fixed_buffer_node_size(allocator, node));
+    UNUSED(size);
 
-        // `node_next` returns NULL when traversal of the list finishes.
-        // This check indicates that we have not found a suitable block of memory to allocate.
-        if (worst_fit == NULL)
-        {
-            return NULL;
-        }
+    fixed_buffer_node_release(allocator, node);
+}
 
-        // We found a node, so we allocate a size out of it.
-        return fixed_buffer_node_reserve(allocator, worst_fit, size);
-    }
-    // Memory is not null, do a free.
-    else if (size == 0)
+static size_t fixed_buffer_allocate_batch(allocator_t* _allocator, size_t size, size_t count, void** memories)
+{
+    fixed_buffer_allocator_t* allocator = FIELD_PARENT_PTR(fixed_buffer_allocator_t, allocator, _allocator);
+
+    if (size == 0 || size > allocator->size)
     {
-        fixed_buffer_node_t* node = fixed_buffer_node_find(allocator, memory);
+        return 0;
+    }
 
-        if (node == NULL)
-        {
-            return NULL;
-        }
+    size = fixed_buffer_size_align(allocator, size);
 
-        fixed_buffer_node_release(allocator, node);
+    size_t allocated = 0;
 
-        return NULL;
-    }
-    // We have a pointer to memory, and a size, do a resize.
-    else
+    // Each search of the strategy yields as many nodes as its hole can hold.
+    while (allocated < count)
     {
-        fixed_buffer_node_t* node = fixed_buffer_node_find(allocator, memory);
+        fixed_buffer_node_t* node = allocator->strategy->find_hole_fn(allocator, size);
 
         if (node == NULL)
         {
-            return NULL;
-        }
-
-        if (size <= node->size)
-        {
-            return memory;
-        }
-
-        void* new_memory = worst_fit_reallocate(_allocator, NULL, size);
-
-        if (new_memory == NULL)
-        {
-            return NULL;
+            break;
         }
 
-        memcpy(new_memory, memory, node->size);
-        fixed_buffer_node_release(allocator, node);
-
-        return new_memory;
+        allocated += fixed_buffer_node_reserve_batch(allocator, node, size, count - allocated, memories + allocated);
     }
+
+    return allocated;
 }
 
-static fixed_buffer_strategy_t worst_fit_strategy_state = {
-    .allocator = { worst_fit_reallocate },
-};
+/**
+ * Orders pointers by address.
+ * @param left A pointer to a pointer
+ * @param right A pointer to a pointer
+ * @return A negative number, zero or a positive number as `left` is below, at or above `right`
+ */
+static int fixed_buffer_memory_compare(const void* left, const void* right)
+{
+    uintptr_t left_address = (uintptr_t) *(void* const*) left;
+    uintptr_t right_address = (uintptr_t) *(void* const*) right;
 
-fixed_buffer_strategy_t* FBS_WORST_FIT = &worst_fit_strategy_state;
+    return (left_address > right_address) - (left_address < right_address);
+}
 
-static void* next_fit_reallocate(allocator_t* _allocator, void* memory, size_t size)
+static void fixed_buffer_deallocate_batch(allocator_t* _allocator, void** memories, size_t count)
 {
     fixed_buffer_allocator_t* allocator = FIELD_PARENT_PTR(fixed_buffer_allocator_t, allocator, _allocator);
 
-    if (memory == NULL && size == 0)
+    // Blocks from `fixed_buffer_allocate_batch/4` come in address order, which is worth checking before sorting.
+    for (size_t i = 1; i < count; ++i)
     {
-        return NULL;
+        if ((uintptr_t) memories[i - 1] > (uintptr_t) memories[i])
+        {
+            qsort(memories, count, sizeof(void*), fixed_buffer_memory_compare);
+            break;
+        }
     }
-    // No memory, but a size given, do memory allocation.
-    else if (memory == NULL)
+
+    size_t i = 0;
+
+    while (i < count)
     {
-        fixed_buffer_node_t* node = allocator->last_node_reserved;
+        fixed_buffer_node_t* first = fixed_buffer_node_find(allocator, memories[i++]);
 
-        // We take the next node after previous allocation
-        if (node != NULL)
+        if (first == NULL)
         {
-            node = fixed_buffer_node_next(allocator, node);
+            continue;
         }
 
-        if (allocator->last_node_reserved == NULL)
+        // Adjacent nodes being deallocated are gathered in a single used node, which is then released once.
+        fixed_buffer_node_t* last = first;
+        fixed_buffer_node_t* next = fixed_buffer_node_next(allocator, last);
+
+        while (i < count && next != NULL && memories[i] == fixed_buffer_node_memory(allocator, next) && !fixed_buffer_node_is_hole(allocator, next))
         {
-            allocator->last_node_reserved = fixed_buffer_node_first(allocator);
+            last = next;
+            next = fixed_buffer_node_next(allocator, last);
+            ++i;
         }
 
-        while (node != allocator->last_node_reserved)
+        if (last != first)
         {
-            // We have a hole with enough bytes available.
-            if (node->is_hole && node->size >= size)
+            size_t size = (size_t) ((char*) fixed_buffer_node_end(allocator, last) - (char*) fixed_buffer_node_memory(allocator, first));
+
+            fixed_buffer_node_t* node = fixed_buffer_node_next(allocator, first);
+
+            while (node != next)
             {
-                break;
+                fixed_buffer_node_t* following = fixed_buffer_node_next(allocator, node);
+                fixed_buffer_node_clear(allocator, node);
+                node = following;
             }
 
-            node = fixed_buffer_node_next(allocator, node);
+            fixed_buffer_node_write(allocator, first, size, false);
 
-            if (node == NULL)
+            if (next != NULL)
             {
-                node = fixed_buffer_node_first(allocator);
+                fixed_buffer_node_link(allocator, first, next);
             }
         }
 
-        // `node_next` returns NULL when traversal of the list finishes.
-        // This check indicates that we have not found a suitable block of memory to allocate.
-        if (node == NULL)
-        {
-            return NULL;
-        }
-
-        // We found a node, so we allocate a size out of it.
-        return fixed_buffer_node_reserve(allocator, node, size);
+        fixed_buffer_node_release(allocator, first);
     }
-    // Memory is not null, do a free.
-    else if (size == 0)
+}
+
+static fixed_buffer_node_t* first_fit_find_hole(fixed_buffer_allocator_t* allocator, size_t size)
+{
+    fixed_buffer_node_t* node = fixed_buffer_hole_first(allocator);
+
+    // We stop at the first hole with enough bytes available.
+    while (node != NULL && fixed_buffer_node_size(allocator, node) < size)
     {
-        fixed_buffer_node_t* node = fixed_buffer_node_find(allocator, memory);
+        node = fixed_buffer_hole_next(allocator, node);
+    }
 
-        if (node == NULL)
-        {
-            return NULL;
-        }
+    return node;
+}
 
-        fixed_buffer_node_release(allocator, node);
+static fixed_buffer_strategy_t first_fit_strategy_state = {
+    .allocator = {
+        fixed_buffer_reallocate,
+        fixed_buffer_reallocate_aligned,
+        fixed_buffer_deallocate_sized,
+        fixed_buffer_allocate_batch,
+        fixed_buffer_deallocate_batch,
+    },
+    .index = &free_list_index,
+    .find_hole_fn = first_fit_find_hole,
+};
+
+fixed_buffer_strategy_t* FBS_FIRST_FIT = &first_fit_strategy_state;
 
+static fixed_buffer_node_t* best_fit_find_hole(fixed_buffer_allocator_t* allocator, size_t size)
+{
+    // The smallest hole with enough bytes available, and the first one in memory among those of that size.
+    return tree_lower_bound(allocator, size);
+}
+
+static fixed_buffer_strategy_t best_fit_strategy_state = {
+    .allocator = {
+        fixed_buffer_reallocate,
+        fixed_buffer_reallocate_aligned,
+        fixed_buffer_deallocate_sized,
+        fixed_buffer_allocate_batch,
+        fixed_buffer_deallocate_batch,
+    },
+    .index = &tree_index,
+    .find_hole_fn = best_fit_find_hole,
+};
+
+fixed_buffer_strategy_t* FBS_BEST_FIT = &best_fit_strategy_state;
+
+static fixed_buffer_node_t* worst_fit_find_hole(fixed_buffer_allocator_t* allocator, size_t size)
+{
+    fixed_buffer_node_t* largest = tree_largest(allocator);
+
+    if (largest == NULL || fixed_buffer_node_size(allocator, largest) < size)
+    {
         return NULL;
     }
-    // We have a pointer to memory, and a size, do a resize.
-    else
+
+    // The largest hole, and the first one in memory among those of that size.
+    return tree_lower_bound(allocator, fixed_buffer_node_size(allocator, largest));
+}
+
+static fixed_buffer_strategy_t worst_fit_strategy_state = {
+    .allocator = {
+        fixed_buffer_reallocate,
+        fixed_buffer_reallocate_aligned,
+        fixed_buffer_deallocate_sized,
+        fixed_buffer_allocate_batch,
+        fixed_buffer_deallocate_batch,
+    },
+    .index = &tree_index,
+    .find_hole_fn = worst_fit_find_hole,
+};
+
+fixed_buffer_strategy_t* FBS_WORST_FIT = &worst_fit_strategy_state;
+
+static fixed_buffer_node_t* next_fit_find_hole(fixed_buffer_allocator_t* allocator, size_t size)
+{
+    fixed_buffer_node_t* start = allocator->holes.list.rover;
+
+    if (start == NULL)
     {
-        fixed_buffer_node_t* node = fixed_buffer_node_find(allocator, memory);
+        start = fixed_buffer_hole_first(allocator);
+    }
 
-        if (node == NULL)
-        {
-            return NULL;
-        }
+    fixed_buffer_node_t* node = start;
 
-        if (size <= node->size)
+    // We take the holes following the previous allocation, wrapping around to the first hole.
+    while (node != NULL)
+    {
+        // We have a hole with enough bytes available.
+        if (fixed_buffer_node_size(allocator, node) >= size)
         {
-            return memory;
+            // The rover follows the hole, so that it moves past the reserved memory.
+            allocator->holes.list.rover = node;
+            return node;
         }
 
-        void* new_memory = first_fit_reallocate(_allocator, NULL, size);
+        node = fixed_buffer_hole_next(allocator, node);
 
-        if (new_memory == NULL)
+        if (node == NULL)
         {
-            return NULL;
+            node = fixed_buffer_hole_first(allocator);
         }
 
-        memcpy(new_memory, memory, node->size);
-        fixed_buffer_node_release(allocator, node);
-
-        return new_memory;
+        if (node == start)
+        {
+            break;
+        }
     }
+
+    return NULL;
 }
 
 static fixed_buffer_strategy_t next_fit_strategy_state = {
-    .allocator = { next_fit_reallocate },
+    .allocator = {
+        fixed_buffer_reallocate,
+        fixed_buffer_reallocate_aligned,
+        fixed_buffer_deallocate_sized,
+        fixed_buffer_allocate_batch,
+        fixed_buffer_deallocate_batch,
+    },
+    .index = &free_list_index,
+    .find_hole_fn = next_fit_find_hole,
 };
 
 fixed_buffer_strategy_t* FBS_NEXT_FIT = &next_fit_strategy_state;
 
+static fixed_buffer_node_t* tlsf_find_hole(fixed_buffer_allocator_t* allocator, size_t size)
+{
+    unsigned fl, sl;
+
+    // Round the size up to the next size class, so that any hole of the class found is large enough.
+    if (size >= ((size_t) 1 << TLSF_FL_SHIFT))
+    {
+        size_t round = ((size_t) 1 << (tlsf_fls(size) - FIXED_BUFFER_TLSF_SL_LOG2)) - 1;
+        tlsf_mapping(size + round, &fl, &sl);
+    }
+    else
+    {
+        tlsf_mapping(size, &fl, &sl);
+    }
+
+    fixed_buffer_node_t* node = tlsf_search(allocator, fl, sl);
+
+    // Only the last class, which gathers all the largest holes, may hold holes that are too small.  Its list is not
+    // searched, so that finding a hole takes constant time.
+    if (node != NULL && fixed_buffer_node_size(allocator, node) >= size)
+    {
+        return node;
+    }
+
+    // Holes of the class of the size itself are skipped by the rounding, which matters when they are all that is left.
+    // Only the head of that class is checked, keeping the search constant.
+    tlsf_mapping(size, &fl, &sl);
+    node = allocator->holes.tlsf.heads[fl][sl];
+
+    return node != NULL && fixed_buffer_node_size(allocator, node) >= size ? node : NULL;
+}
+
+static fixed_buffer_strategy_t tlsf_strategy_state = {
+    .allocator = {
+        fixed_buffer_reallocate,
+        fixed_buffer_reallocate_aligned,
+        fixed_buffer_deallocate_sized,
+        fixed_buffer_allocate_batch,
+        fixed_buffer_deallocate_batch,
+    },
+    .index = &tlsf_index,
+    .find_hole_fn = tlsf_find_hole,
+};
+
+fixed_buffer_strategy_t* FBS_TLSF = &tlsf_strategy_state;
+
 fixed_buffer_allocator_t fixed_buffer_allocator_init(fixed_buffer_strategy_t* strategy, void* buffer, size_t size)
+{
+    return fixed_buffer_allocator_init_with_layout(strategy, FBL_STANDARD, buffer, size);
+}
+
+fixed_buffer_allocator_t fixed_buffer_allocator_init_with_layout(
+    fixed_buffer_strategy_t* strategy,
+    fixed_buffer_layout_t* layout,
+    void* buffer,
+    size_t size
+)
 {
     if (strategy == NULL)
     {
         strategy = FBS_FIRST_FIT;
     }
 
+    if (layout == NULL)
+    {
+        layout = FBL_STANDARD;
+    }
+
     fixed_buffer_allocator_t allocator;
     allocator.allocator = strategy->allocator;
+    allocator.strategy = strategy;
+    allocator.layout = layout;
     allocator.buffer = buffer;
     allocator.size = size;
+    allocator.decommit_threshold = 0;
+    allocator.page_size = 0;
+    allocator.shared = false;
+
+    size_t node_size = (size - layout->header_size) & ~(FIXED_BUFFER_ALIGNMENT - 1);
+
+    // Compact headers can only describe sizes that fit in their size bits.
+    if (layout->compact && (uint64_t) node_size > FIXED_BUFFER_COMPACT_SIZE_MASK)
+    {
+        node_size = (size_t) FIXED_BUFFER_COMPACT_SIZE_MASK;
+        allocator.size = node_size + layout->header_size;
+    }
 
     fixed_buffer_node_t* node = (fixed_buffer_node_t*) buffer;
-    node->is_hole = true;
-    node->size = size - sizeof(fixed_buffer_node_t);
-    node->previous = NULL;
+    fixed_buffer_node_write(&allocator, node, node_size, true);
+    fixed_buffer_node_link(&allocator, NULL, node);
+
+    strategy->index->clear_fn(&allocator);
+    strategy->index->insert_fn(&allocator, node);
 
     return allocator;
 }
 
 void fixed_buffer_allocator_set_strategy(fixed_buffer_allocator_t* allocator, fixed_buffer_strategy_t* strategy)
+{
+    const fixed_buffer_index_t* index = allocator->strategy->index;
+
+    allocator->allocator = strategy->allocator;
+    allocator->strategy = strategy;
+
+    // Strategies sharing an index can be switched freely, others need the holes to be indexed again.
+    if (strategy->index != index)
+    {
+        fixed_buffer_index_rebuild(allocator);
+    }
+}
+
+void fixed_buffer_allocator_reattach(
+    fixed_buffer_allocator_t* allocator,
+    fixed_buffer_strategy_t* strategy,
+    fixed_buffer_layout_t* layout,
+    void* buffer
+)
 {
     allocator->allocator = strategy->allocator;
+    allocator->strategy = strategy;
+    allocator->layout = layout;
+
+    if (allocator->buffer == buffer)
+    {
+        return;
+    }
+
+    // Nodes only hold absolute pointers to their previous node and in the index, so walking them by size is enough to
+    // rewrite the former and rebuild the latter.
+    allocator->buffer = buffer;
+
+    fixed_buffer_node_t* previous = NULL;
+
+    for (fixed_buffer_node_t* node = fixed_buffer_node_first(allocator); node != NULL; node = fixed_buffer_node_next(allocator, node))
+    {
+        fixed_buffer_node_link(allocator, previous, node);
+        previous = node;
+    }
+
+    fixed_buffer_index_rebuild(allocator);
+}
+
+/**
+ * Returns the size of the pages of the system.
+ * @return A size in bytes
+ */
+static size_t fixed_buffer_page_size(void)
+{
+#if defined(__unix__) || defined(__APPLE__)
+    long page_size = sysconf(_SC_PAGESIZE);
+
+    if (page_size > 0)
+    {
+        return (size_t) page_size;
+    }
+#endif
+
+    return 4096;
+}
+
+void fixed_buffer_allocator_set_decommit(fixed_buffer_allocator_t* allocator, size_t threshold)
+{
+    allocator->page_size = fixed_buffer_page_size();
+    allocator->decommit_threshold = allocator->shared ? 0 : threshold;
+}
+
+void fixed_buffer_allocator_set_shared(fixed_buffer_allocator_t* allocator, bool shared)
+{
+    allocator->shared = shared;
+
+    if (shared)
+    {
+        allocator->decommit_threshold = 0;
+    }
+}
+
+size_t fixed_buffer_allocator_trim(fixed_buffer_allocator_t* allocator)
+{
+    size_t size = 0;
+
+    if (allocator->shared)
+    {
+        return 0;
+    }
+
+    if (allocator->page_size == 0)
+    {
+        allocator->page_size = fixed_buffer_page_size();
+    }
+
+    for (fixed_buffer_node_t* node = fixed_buffer_hole_first(allocator); node != NULL; node = fixed_buffer_hole_next(allocator, node))
+    {
+        if (!fixed_buffer_node_is_decommitted(allocator, node))
+        {
+            size += fixed_buffer_hole_decommit(allocator, node, (char*) node, (char*) fixed_buffer_node_end(allocator, node));
+        }
+    }
+
+    return size;
+}
+
+size_t fixed_buffer_allocator_overhead(fixed_buffer_allocator_t* allocator)
+{
+    size_t overhead = 0;
+
+    for (fixed_buffer_node_t* node = fixed_buffer_node_first(allocator); node != NULL; node = fixed_buffer_node_next(allocator, node))
+    {
+        overhead += allocator->layout->header_size;
+    }
+
+    return overhead;
 }
 
 void fixed_buffer_allocator_debug(fixed_buffer_allocator_t* allocator, FILE* file)
 {
     int i = 0;
+    size_t header_size = allocator->layout->header_size;
     fixed_buffer_node_t* node = fixed_buffer_node_first(allocator);
 
     while (node != NULL)
     {
-        fprintf(file, "[BLOCK %d] - %s (%zu bytes)\n", i, node->is_hole ? "free" : "used", 24 + node->size);
-        fprintf(file, "\theader (%d bytes) \t@ %zu\n", 24, (size_t)(((char*)node) - ((char*)allocator->buffer)));
-        fprintf(file, "\tmemory (%zu bytes) \t@ %zu\n\n", node->size, (size_t)(((char*)fixed_buffer_node_memory(node)) - ((char*)allocator->buffer)));
+        size_t size = fixed_buffer_node_size(allocator, node);
+
+        fprintf(file, "[BLOCK %d] - %s (%zu bytes)\n", i, fixed_buffer_node_is_hole(allocator, node) ? "free" : "used", header_size + size);
+        fprintf(file, "\theader (%zu bytes) \t@ %zu\n", header_size, (size_t)(((char*)node) - ((char*)allocator->buffer)));
+        fprintf(file, "\tmemory (%zu bytes) \t@ %zu\n\n", size, (size_t)(((char*)fixed_buffer_node_memory(allocator, node)) - ((char*)allocator->buffer)));
 
         node = fixed_buffer_node_next(allocator, node);
         ++i;
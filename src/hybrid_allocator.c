@@ -0,0 +1,267 @@
+#include "allocators/hybrid_allocator.h"
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "./macros.h"
+
+/**
+ * The tags telling which allocator owns a block.
+ */
+#define HYBRID_SMALL UINT32_C(0x48594253)
+#define HYBRID_LARGE UINT32_C(0x4859424C)
+
+/**
+ * The header in front of every block, keeping it aligned for any fundamental type.
+ */
+typedef struct {
+    /**
+     * The size of the block as last requested.
+     */
+    size_t size;
+    /**
+     * `HYBRID_SMALL` or `HYBRID_LARGE`.
+     */
+    uint32_t tag;
+    /**
+     * The distance in bytes from the beginning of the block of the owner to the header, which is only padded for large
+     * blocks aligned beyond the size of the header, and so less than a page.
+     */
+    uint32_t offset;
+} hybrid_header_t;
+
+/**
+ * The size of the header, rounded up to the alignment of any fundamental type.
+ */
+#define HYBRID_HEADER_SIZE \
+    ((sizeof(hybrid_header_t) + _Alignof(max_align_t) - 1) & ~(_Alignof(max_align_t) - 1))
+
+/**
+ * Returns the header of a block.
+ * @param memory A block of a hybrid allocator
+ * @return A header
+ */
+static hybrid_header_t* hybrid_header(void* memory)
+{
+    return (hybrid_header_t*) ((char*) memory - HYBRID_HEADER_SIZE);
+}
+
+/**
+ * Returns the beginning of the block of the owner holding a block.
+ * @param header The header of a block of a hybrid allocator
+ * @return A pointer
+ */
+static void* hybrid_block(hybrid_header_t* header)
+{
+    return (char*) header - header->offset;
+}
+
+/**
+ * Returns the padding needed in front of the header for the memory after it to have an alignment.
+ * @param alignment A power of two, or 0 for the default alignment of the allocators
+ * @return A size in bytes
+ */
+static size_t hybrid_offset(size_t alignment)
+{
+    return alignment > HYBRID_HEADER_SIZE ? alignment - HYBRID_HEADER_SIZE : 0;
+}
+
+/**
+ * Returns the allocator owning a block.
+ * @param allocator A hybrid allocator
+ * @param header The header of a block of the allocator
+ * @return An allocator
+ */
+static allocator_t* hybrid_owner(hybrid_allocator_t* allocator, hybrid_header_t* header)
+{
+    assert(header->tag == HYBRID_SMALL || header->tag == HYBRID_LARGE);
+
+    return header->tag == HYBRID_LARGE ? &allocator->pages.allocator : allocator->inner;
+}
+
+/**
+ * Reallocates memory with an allocator, with its default alignment if none is given.
+ * @param allocator An allocator
+ * @param memory A pointer, or `NULL`
+ * @param size A size in bytes
+ * @param alignment A power of two, or 0 for the default alignment of the allocator
+ * @return A pointer, or `NULL`
+ */
+static void* hybrid_reallocate_with(allocator_t* allocator, void* memory, size_t size, size_t alignment)
+{
+    return alignment == 0 ? reallocate(allocator, memory, size) : reallocate_aligned(allocator, memory, size, alignment);
+}
+
+/**
+ * Allocates a block from the allocator matching its size.
+ *
+ * Blocks start right after their header, so small blocks can only have the alignments dividing its size.  Large blocks
+ * come from the page allocator, which aligns them as requested, and are padded in front of their header for the memory
+ * to have alignments up to a page.
+ * @param allocator A hybrid allocator
+ * @param size A size in bytes
+ * @param alignment A power of two, or 0 for the default alignment of the allocators
+ * @return A block, or `NULL`
+ */
+static void* hybrid_allocate(hybrid_allocator_t* allocator, size_t size, size_t alignment)
+{
+    bool large = size > allocator->threshold;
+
+    if (alignment > (large ? allocator->pages.page_size : HYBRID_HEADER_SIZE))
+    {
+        return NULL;
+    }
+
+    size_t offset = hybrid_offset(alignment);
+
+    if (size > SIZE_MAX - HYBRID_HEADER_SIZE - offset)
+    {
+        return NULL;
+    }
+
+    allocator_t* owner = large ? &allocator->pages.allocator : allocator->inner;
+    char* block = hybrid_reallocate_with(owner, NULL, offset + HYBRID_HEADER_SIZE + size, alignment);
+
+    if (block == NULL)
+    {
+        return NULL;
+    }
+
+    hybrid_header_t* header = (hybrid_header_t*) (block + offset);
+    header->size = size;
+    header->tag = large ? HYBRID_LARGE : HYBRID_SMALL;
+    header->offset = (uint32_t) offset;
+
+    return (char*) header + HYBRID_HEADER_SIZE;
+}
+
+bool hybrid_allocator_is_large(hybrid_allocator_t* allocator, void* memory)
+{
+    UNUSED(allocator);
+
+    return hybrid_header(memory)->tag == HYBRID_LARGE;
+}
+
+/**
+ * Reallocates memory, from the allocator matching its new size.
+ * @param allocator A hybrid allocator
+ * @param memory A pointer, or `NULL`
+ * @param size A size in bytes
+ * @param alignment A power of two, up to `HYBRID_HEADER_SIZE` for small blocks and up to a page for large blocks, or 0
+ * for the default alignment of the allocators
+ * @return A pointer, or `NULL`
+ */
+static void* hybrid_reallocate(hybrid_allocator_t* allocator, void* memory, size_t size, size_t alignment)
+{
+    if (memory == NULL && size == 0)
+    {
+        return NULL;
+    }
+    // No memory, but a size given, allocate from the allocator matching the size.
+    else if (memory == NULL)
+    {
+        return hybrid_allocate(allocator, size, alignment);
+    }
+
+    hybrid_header_t* header = hybrid_header(memory);
+    allocator_t* owner = hybrid_owner(allocator, header);
+
+    // Memory is not null, free it in the allocator owning it.
+    if (size == 0)
+    {
+        deallocate(owner, hybrid_block(header));
+        return NULL;
+    }
+
+    // Blocks stay with their owner, unless a small block grows past the threshold or a large block needs more padding
+    // for a stricter alignment.  Large blocks keep their padding, and so their alignment, and are remapped.
+    size_t offset = hybrid_offset(alignment);
+
+    if (header->tag == HYBRID_SMALL && size <= allocator->threshold)
+    {
+        if (offset > 0)
+        {
+            return NULL;
+        }
+
+        header = hybrid_reallocate_with(owner, header, HYBRID_HEADER_SIZE + size, alignment);
+
+        if (header == NULL)
+        {
+            return NULL;
+        }
+
+        header->size = size;
+
+        return (char*) header + HYBRID_HEADER_SIZE;
+    }
+    else if (header->tag == HYBRID_LARGE && offset <= header->offset)
+    {
+        offset = header->offset;
+
+        if (size > SIZE_MAX - HYBRID_HEADER_SIZE - offset)
+        {
+            return NULL;
+        }
+
+        size_t block_size = offset + HYBRID_HEADER_SIZE + size;
+        size_t block_alignment = offset > 0 ? offset + HYBRID_HEADER_SIZE : alignment;
+        char* block = hybrid_reallocate_with(owner, hybrid_block(header), block_size, block_alignment);
+
+        if (block == NULL)
+        {
+            return NULL;
+        }
+
+        header = (hybrid_header_t*) (block + offset);
+        header->size = size;
+
+        return (char*) header + HYBRID_HEADER_SIZE;
+    }
+
+    void* new_memory = hybrid_allocate(allocator, size, alignment);
+
+    if (new_memory == NULL)
+    {
+        return NULL;
+    }
+
+    memcpy(new_memory, memory, header->size < size ? header->size : size);
+    deallocate(owner, hybrid_block(header));
+
+    return new_memory;
+}
+
+static void* hybrid_allocator_reallocate(allocator_t* _allocator, void* memory, size_t size)
+{
+    hybrid_allocator_t* allocator = FIELD_PARENT_PTR(hybrid_allocator_t, allocator, _allocator);
+
+    return hybrid_reallocate(allocator, memory, size, 0);
+}
+
+static void* hybrid_allocator_reallocate_aligned(allocator_t* _allocator, void* memory, size_t size, size_t alignment)
+{
+    hybrid_allocator_t* allocator = FIELD_PARENT_PTR(hybrid_allocator_t, allocator, _allocator);
+
+    return hybrid_reallocate(allocator, memory, size, alignment);
+}
+
+static const allocator_t hybrid_allocator_vtable = {
+    hybrid_allocator_reallocate,
+    hybrid_allocator_reallocate_aligned,
+    NULL,
+    NULL,
+    NULL,
+};
+
+hybrid_allocator_t hybrid_allocator_init(allocator_t* inner, unsigned flags, size_t threshold)
+{
+    hybrid_allocator_t allocator;
+    allocator.allocator = hybrid_allocator_vtable;
+    allocator.inner = inner;
+    allocator.pages = page_allocator_init(flags);
+    allocator.threshold = threshold;
+
+    return allocator;
+}
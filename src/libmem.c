@@ -6,7 +6,7 @@ fixed_buffer_allocator_t fba;
 
 static fixed_buffer_node_t* getNodeAtIndex(fixed_buffer_allocator_t* fba, size_t block)
 {
-    int i = 0;
+    size_t i = 0;
     fixed_buffer_node_t* node = fixed_buffer_node_first(fba);
 
     while (node && i < block)
@@ -41,6 +41,9 @@ void initmem(enum mem_strategy strategy, void* buffer, size_t size)
         case ms_next_fit:
             fba = fixed_buffer_allocator_init(FBS_NEXT_FIT, buffer, size);
             break;
+        case ms_tlsf:
+            fba = fixed_buffer_allocator_init(FBS_TLSF, buffer, size);
+            break;
         default:
             fputs("unknown strategy\n", stderr);
             exit(EXIT_FAILURE);
@@ -63,6 +66,9 @@ void setstrategy(enum mem_strategy strategy)
         case ms_next_fit:
             fixed_buffer_allocator_set_strategy(&fba, FBS_NEXT_FIT);
             break;
+        case ms_tlsf:
+            fixed_buffer_allocator_set_strategy(&fba, FBS_TLSF);
+            break;
     }
     
 }
@@ -83,9 +89,9 @@ void liberebloc(size_t block)
 
     if (node != NULL)
     {
-        if (!node->is_hole)
+        if (!fixed_buffer_node_is_hole(&fba, node))
         {
-            deallocate(&fba.allocator, fixed_buffer_node_memory(node));
+            deallocate(&fba.allocator, fixed_buffer_node_memory(&fba, node));
         }
     }
 }
@@ -95,9 +101,9 @@ void clearmem()
     fixed_buffer_node_t* node = fixed_buffer_node_first(&fba);
     while (node)
     {
-        if (!node->is_hole)
+        if (!fixed_buffer_node_is_hole(&fba, node))
         {
-            deallocate(&fba.allocator, fixed_buffer_node_memory(node));
+            deallocate(&fba.allocator, fixed_buffer_node_memory(&fba, node));
         }
         node = fixed_buffer_node_next(&fba, node);
     }
@@ -107,15 +113,12 @@ size_t nbloclibre()
 {
     size_t usable = 0;
 
-    fixed_buffer_node_t* node = fixed_buffer_node_first(&fba);
+    fixed_buffer_node_t* node = fixed_buffer_hole_first(&fba);
     while (node != NULL)
     {
-        if (node->is_hole)
-        {
-            usable += node->size;
-        }
+        usable += fixed_buffer_node_size(&fba, node);
 
-        node = fixed_buffer_node_next(&fba, node);
+        node = fixed_buffer_hole_next(&fba, node);
     }
 
     return usable;
@@ -128,12 +131,12 @@ size_t nblocalloue()
     fixed_buffer_node_t* node = fixed_buffer_node_first(&fba);
     while (node != NULL)
     {
-        if (!node->is_hole)
+        if (!fixed_buffer_node_is_hole(&fba, node))
         {
-            used += node->size;
+            used += fixed_buffer_node_size(&fba, node);
         }
 
-        used += sizeof(fixed_buffer_node_t);
+        used += fixed_buffer_layout_header_size(fba.layout);
 
         node = fixed_buffer_node_next(&fba, node);
     }
@@ -143,40 +146,29 @@ size_t nblocalloue()
 
 size_t mem_pgrand_libre()
 {
-    fixed_buffer_node_t* largest = NULL;
-
-    fixed_buffer_node_t* node = fixed_buffer_node_first(&fba);
-    while (node != NULL)
-    {
-        if (node->is_hole && (largest == NULL || node->size > largest->size))
-        {
-            largest = node;
-        }
-
-        node = fixed_buffer_node_next(&fba, node);
-    }
+    fixed_buffer_node_t* largest = fixed_buffer_hole_largest(&fba);
 
     if (largest == NULL)
     {
         return 0;
     }
 
-    return largest->size;
+    return fixed_buffer_node_size(&fba, largest);
 }
 
 size_t mem_small_free(size_t threshold)
 {
     size_t n = 0;
 
-    fixed_buffer_node_t* node = fixed_buffer_node_first(&fba);
+    fixed_buffer_node_t* node = fixed_buffer_hole_first(&fba);
     while (node != NULL)
     {
-        if (node->is_hole && node->size <= threshold)
+        if (fixed_buffer_node_size(&fba, node) <= threshold)
         {
             n++;
         }
 
-        node = fixed_buffer_node_next(&fba, node);
+        node = fixed_buffer_hole_next(&fba, node);
     }
 
     return n;
@@ -0,0 +1,189 @@
+#include "allocators/lockfree_pool_allocator.h"
+
+#include "./macros.h"
+
+/**
+ * The alignment of blocks, which hold the index of the next free block when free.
+ */
+#define LOCKFREE_POOL_ALIGNMENT ((size_t) 8)
+
+/**
+ * Packs a tag and an index in a value of the head.
+ * @param tag A tag
+ * @param index An index
+ * @return A value of the head
+ */
+static uint_least64_t lockfree_pool_pack(uint_least64_t tag, uint32_t index)
+{
+    return (tag << 32) | index;
+}
+
+/**
+ * Returns the index stored in a value of the head.
+ * @param head A value of the head
+ * @return An index
+ */
+static uint32_t lockfree_pool_index(uint_least64_t head)
+{
+    return (uint32_t) (head & UINT32_MAX);
+}
+
+/**
+ * Returns the tag stored in a value of the head, plus one.
+ * @param head A value of the head
+ * @return A tag
+ */
+static uint_least64_t lockfree_pool_next_tag(uint_least64_t head)
+{
+    return ((head >> 32) + 1) & UINT32_MAX;
+}
+
+/**
+ * Returns the link of a block to the next free block.  It is atomic since a thread popping a block may read it while
+ * another thread which already popped that block writes to it, in which case the tag makes the value read unused.
+ * @param allocator A lock-free pool allocator
+ * @param index The index of a block
+ * @return A pointer to the link
+ */
+static atomic_uint_least32_t* lockfree_pool_link(lockfree_pool_allocator_t* allocator, uint32_t index)
+{
+    return (atomic_uint_least32_t*) ((char*) allocator->buffer + (size_t) index * allocator->block_size);
+}
+
+/**
+ * Pops the first free block.
+ * @param allocator A lock-free pool allocator
+ * @return A pointer to a block, or `NULL` if all blocks are used
+ */
+static void* lockfree_pool_pop(lockfree_pool_allocator_t* allocator)
+{
+    uint_least64_t head = atomic_load_explicit(&allocator->head, memory_order_acquire);
+    uint_least64_t new_head;
+    uint32_t index;
+
+    do
+    {
+        index = lockfree_pool_index(head);
+
+        if (index == allocator->block_count)
+        {
+            return NULL;
+        }
+
+        uint32_t next = atomic_load_explicit(lockfree_pool_link(allocator, index), memory_order_relaxed);
+        new_head = lockfree_pool_pack(lockfree_pool_next_tag(head), next);
+    }
+    while (!atomic_compare_exchange_weak_explicit(&allocator->head, &head, new_head, memory_order_acquire, memory_order_acquire));
+
+    return (char*) allocator->buffer + (size_t) index * allocator->block_size;
+}
+
+/**
+ * Pushes a block on the free blocks.
+ * @param allocator A lock-free pool allocator
+ * @param memory A pointer to a block
+ */
+static void lockfree_pool_push(lockfree_pool_allocator_t* allocator, void* memory)
+{
+    uint32_t index = (uint32_t) ((size_t) ((char*) memory - (char*) allocator->buffer) / allocator->block_size);
+    atomic_uint_least32_t* link = lockfree_pool_link(allocator, index);
+    uint_least64_t head = atomic_load_explicit(&allocator->head, memory_order_relaxed);
+    uint_least64_t new_head;
+
+    do
+    {
+        atomic_store_explicit(link, lockfree_pool_index(head), memory_order_relaxed);
+        new_head = lockfree_pool_pack(lockfree_pool_next_tag(head), index);
+    }
+    while (!atomic_compare_exchange_weak_explicit(&allocator->head, &head, new_head, memory_order_release, memory_order_relaxed));
+}
+
+static void* lockfree_pool_allocator_reallocate(allocator_t* _allocator, void* memory, size_t size)
+{
+    lockfree_pool_allocator_t* allocator = FIELD_PARENT_PTR(lockfree_pool_allocator_t, allocator, _allocator);
+
+    if (memory == NULL && size == 0)
+    {
+        return NULL;
+    }
+    // No memory, but a size given, pop a block from the free list.
+    else if (memory == NULL)
+    {
+        return size <= allocator->block_size ? lockfree_pool_pop(allocator) : NULL;
+    }
+    // Memory is not null, push it back on the free list.
+    else if (size == 0)
+    {
+        lockfree_pool_push(allocator, memory);
+        return NULL;
+    }
+    // All blocks have the same size, so a resize either fits in place or fails.
+    else
+    {
+        return size <= allocator->block_size ? memory : NULL;
+    }
+}
+
+static void* lockfree_pool_allocator_reallocate_aligned(allocator_t* _allocator, void* memory, size_t size, size_t alignment)
+{
+    lockfree_pool_allocator_t* allocator = FIELD_PARENT_PTR(lockfree_pool_allocator_t, allocator, _allocator);
+
+    // Blocks follow each other from the beginning of the buffer, so they are only aligned as much as both.
+    if ((((uintptr_t) allocator->buffer | allocator->block_size) & (alignment - 1)) != 0)
+    {
+        return NULL;
+    }
+
+    return lockfree_pool_allocator_reallocate(_allocator, memory, size);
+}
+
+static const allocator_t lockfree_pool_allocator_vtable = {
+    lockfree_pool_allocator_reallocate,
+    lockfree_pool_allocator_reallocate_aligned,
+    NULL,
+    NULL,
+    NULL,
+};
+
+lockfree_pool_allocator_t lockfree_pool_allocator_init(void* buffer, size_t size, size_t block_size)
+{
+    if (block_size < LOCKFREE_POOL_ALIGNMENT)
+    {
+        block_size = LOCKFREE_POOL_ALIGNMENT;
+    }
+
+    block_size = (block_size + LOCKFREE_POOL_ALIGNMENT - 1) & ~(LOCKFREE_POOL_ALIGNMENT - 1);
+
+    // The index equal to the block count marks the end of the free list, so it must fit in the index too.
+    size_t block_count = size / block_size;
+
+    if (block_count >= UINT32_MAX)
+    {
+        block_count = UINT32_MAX - 1;
+    }
+
+    lockfree_pool_allocator_t allocator;
+    allocator.allocator = lockfree_pool_allocator_vtable;
+    allocator.buffer = buffer;
+    allocator.block_size = block_size;
+    allocator.block_count = (uint32_t) block_count;
+
+    for (uint32_t i = 0; i < allocator.block_count; ++i)
+    {
+        atomic_init(lockfree_pool_link(&allocator, i), i + 1);
+    }
+
+    atomic_init(&allocator.head, lockfree_pool_pack(0, 0));
+
+    return allocator;
+}
+
+bool lockfree_pool_allocator_owns(lockfree_pool_allocator_t* allocator, void* memory)
+{
+    char* pointer = (char*) memory;
+    char* buffer = (char*) allocator->buffer;
+
+    return pointer >= buffer
+        && pointer < buffer + (size_t) allocator->block_count * allocator->block_size
+        && (size_t) (pointer - buffer) % allocator->block_size == 0;
+}
@@ -0,0 +1,292 @@
+#if !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include "allocators/page_allocator.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "./macros.h"
+
+#if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+
+/**
+ * The header in front of the memory of a mapping.
+ */
+typedef struct {
+    /**
+     * The beginning of the mapping.
+     */
+    char* base;
+    /**
+     * The size of the mapping in bytes.
+     */
+    size_t length;
+    /**
+     * The size of the pages backing the mapping, by which it can be shortened.
+     */
+    size_t granule;
+} page_header_t;
+
+_Static_assert(sizeof(page_header_t) <= PAGE_HEADER_SIZE, "page headers must fit in PAGE_HEADER_SIZE");
+
+/**
+ * Rounds a size up to a multiple of a granule, or returns 0 on overflow.
+ * @param size A size in bytes
+ * @param granule A power of two
+ * @return The rounded size
+ */
+static size_t page_round(size_t size, size_t granule)
+{
+    return size > SIZE_MAX - (granule - 1) ? 0 : (size + granule - 1) & ~(granule - 1);
+}
+
+/**
+ * Returns the header of an allocation.
+ * @param memory An allocation of a page allocator
+ * @return A header
+ */
+static page_header_t* page_header(void* memory)
+{
+    return (page_header_t*) ((char*) memory - PAGE_HEADER_SIZE);
+}
+
+/**
+ * Prefaults the pages of a range that grew, as `MAP_POPULATE` does when a mapping is created.
+ * @param begin The beginning of the range, on a page boundary
+ * @param length The size of the range in bytes, a multiple of `granule`
+ * @param granule The size of the pages backing the range
+ */
+static void page_populate(char* begin, size_t length, size_t granule)
+{
+#if defined(MADV_POPULATE_WRITE)
+    if (madvise(begin, length, MADV_POPULATE_WRITE) == 0)
+    {
+        return;
+    }
+#endif
+
+    // The pages are new and zeroed, so writing a zero to each of them faults them in without changing them.
+    for (size_t offset = 0; offset < length; offset += granule)
+    {
+        ((volatile char*) begin)[offset] = 0;
+    }
+}
+
+/**
+ * Maps at least `size` bytes, in huge pages if requested and available.
+ * @param allocator A page allocator
+ * @param size A size in bytes
+ * @param header A header receiving the extent of the mapping
+ * @return If the mapping could be created
+ */
+static bool page_map(page_allocator_t* allocator, size_t size, page_header_t* header)
+{
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+
+#if defined(MAP_POPULATE)
+    if (allocator->flags & PAGE_POPULATE)
+    {
+        flags |= MAP_POPULATE;
+    }
+#endif
+
+#if defined(MAP_HUGETLB)
+    if (allocator->flags & PAGE_HUGETLB)
+    {
+        size_t length = page_round(size, PAGE_HUGE_SIZE);
+        void* base = length != 0 ? mmap(NULL, length, PROT_READ | PROT_WRITE, flags | MAP_HUGETLB, -1, 0) : MAP_FAILED;
+
+        if (base != MAP_FAILED)
+        {
+            header->base = (char*) base;
+            header->length = length;
+            header->granule = PAGE_HUGE_SIZE;
+
+            return true;
+        }
+    }
+#endif
+
+    size_t length = page_round(size, allocator->page_size);
+    void* base = length != 0 ? mmap(NULL, length, PROT_READ | PROT_WRITE, flags, -1, 0) : MAP_FAILED;
+
+    if (base == MAP_FAILED)
+    {
+        return false;
+    }
+
+#if defined(MADV_HUGEPAGE)
+    if (allocator->flags & PAGE_TRANSPARENT_HUGE)
+    {
+        madvise(base, length, MADV_HUGEPAGE);
+    }
+#endif
+
+    header->base = (char*) base;
+    header->length = length;
+    header->granule = allocator->page_size;
+
+    return true;
+}
+
+/**
+ * Maps a new allocation.
+ * @param allocator A page allocator
+ * @param size A size in bytes
+ * @param alignment A power of two
+ * @return A pointer, or `NULL` if the mapping could not be created
+ */
+static void* page_allocate(page_allocator_t* allocator, size_t size, size_t alignment)
+{
+    // The memory follows the header, so alignments up to its size come for free.
+    size_t padding = alignment > PAGE_HEADER_SIZE ? alignment : 0;
+
+    if (size > SIZE_MAX - PAGE_HEADER_SIZE - padding)
+    {
+        return NULL;
+    }
+
+    page_header_t header;
+
+    if (!page_map(allocator, PAGE_HEADER_SIZE + padding + size, &header))
+    {
+        return NULL;
+    }
+
+    char* memory = header.base + PAGE_HEADER_SIZE;
+    memory += (size_t) (-(uintptr_t) memory & (alignment - 1));
+
+    memcpy(page_header(memory), &header, sizeof(page_header_t));
+
+    return memory;
+}
+
+/**
+ * Unmaps an allocation.
+ * @param memory An allocation of a page allocator
+ */
+static void page_deallocate(void* memory)
+{
+    page_header_t* header = page_header(memory);
+    munmap(header->base, header->length);
+}
+
+size_t page_allocator_capacity(page_allocator_t* allocator, void* memory)
+{
+    UNUSED(allocator);
+
+    page_header_t* header = page_header(memory);
+
+    return (size_t) (header->base + header->length - (char*) memory);
+}
+
+static void* page_allocator_reallocate_aligned(allocator_t* _allocator, void* memory, size_t size, size_t alignment)
+{
+    page_allocator_t* allocator = FIELD_PARENT_PTR(page_allocator_t, allocator, _allocator);
+
+    if (memory == NULL && size == 0)
+    {
+        return NULL;
+    }
+    // No memory, but a size given, map new pages.
+    else if (memory == NULL)
+    {
+        return page_allocate(allocator, size, alignment);
+    }
+    // Memory is not null, unmap its pages.
+    else if (size == 0)
+    {
+        page_deallocate(memory);
+        return NULL;
+    }
+
+    page_header_t* header = page_header(memory);
+    size_t capacity = page_allocator_capacity(allocator, memory);
+
+    // The memory can be kept if it fits in the mapping and is aligned, whole pages past the new end being unmapped.
+    if (size <= capacity && ((uintptr_t) memory & (alignment - 1)) == 0)
+    {
+        size_t length = page_round((size_t) ((char*) memory - header->base) + size, header->granule);
+
+        if (length < header->length)
+        {
+            munmap(header->base + length, header->length - length);
+            header->length = length;
+        }
+
+        return memory;
+    }
+
+#if defined(MREMAP_MAYMOVE)
+    // Regular pages keep their offset when the mapping is moved, so the kernel can move the page table entries instead of
+    // the bytes being copied, as long as the alignment does not exceed a page.
+    if (header->granule == allocator->page_size && alignment <= allocator->page_size && ((uintptr_t) memory & (alignment - 1)) == 0)
+    {
+        size_t offset = (size_t) ((char*) memory - header->base);
+        size_t length = offset + size >= offset ? page_round(offset + size, header->granule) : 0;
+        void* base = length != 0 ? mremap(header->base, header->length, length, MREMAP_MAYMOVE) : MAP_FAILED;
+
+        if (base == MAP_FAILED)
+        {
+            return NULL;
+        }
+
+        memory = (char*) base + offset;
+        header = page_header(memory);
+
+        // The pages added to the mapping are not prefaulted by `mremap`, unlike those of a mapping created populated.
+        if ((allocator->flags & PAGE_POPULATE) && length > header->length)
+        {
+            page_populate((char*) base + header->length, length - header->length, header->granule);
+        }
+
+        header->base = (char*) base;
+        header->length = length;
+
+        return memory;
+    }
+#endif
+
+    void* new_memory = page_allocate(allocator, size, alignment);
+
+    if (new_memory == NULL)
+    {
+        return NULL;
+    }
+
+    memcpy(new_memory, memory, capacity < size ? capacity : size);
+    page_deallocate(memory);
+
+    return new_memory;
+}
+
+static void* page_allocator_reallocate(allocator_t* allocator, void* memory, size_t size)
+{
+    return page_allocator_reallocate_aligned(allocator, memory, size, PAGE_HEADER_SIZE);
+}
+
+static const allocator_t page_allocator_vtable = {
+    page_allocator_reallocate,
+    page_allocator_reallocate_aligned,
+    NULL,
+    NULL,
+    NULL,
+};
+
+page_allocator_t page_allocator_init(unsigned flags)
+{
+    long page_size = sysconf(_SC_PAGESIZE);
+
+    page_allocator_t allocator;
+    allocator.allocator = page_allocator_vtable;
+    allocator.flags = flags;
+    allocator.page_size = page_size > 0 ? (size_t) page_size : 4096;
+
+    return allocator;
+}
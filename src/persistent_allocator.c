@@ -0,0 +1,418 @@
+#if !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include "allocators/persistent_allocator.h"
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "./macros.h"
+
+/**
+ * The tag at the beginning of every persistent heap file.
+ */
+#define PERSISTENT_MAGIC UINT64_C(0x5045524D48454150)
+
+/**
+ * The version of the format of persistent heap files, to be incremented whenever `persistent_root_t` or the layout of
+ * the heap changes.
+ */
+#define PERSISTENT_VERSION 2
+
+struct persistent_root {
+    uint64_t magic;
+    uint32_t version;
+    /**
+     * Nonzero while the heap may have been modified since the last checkpoint.
+     */
+    uint32_t dirty;
+    /**
+     * The index of the strategy of the heap in `persistent_strategies/1`.
+     */
+    uint32_t strategy;
+    /**
+     * The index of the layout of the heap in `persistent_layouts/1`.
+     */
+    uint32_t layout;
+    /**
+     * The size of the file in bytes.
+     */
+    uint64_t size;
+    /**
+     * The address at which the file was mapped when the state of the heap was last written.
+     */
+    uint64_t address;
+    /**
+     * The offset of the entry point of the data of the heap, or 0.
+     */
+    uint64_t entry;
+    /**
+     * The state of the heap.  Its pointers are valid at `address` only.
+     */
+    fixed_buffer_allocator_t heap;
+};
+
+_Static_assert(sizeof(persistent_root_t) <= PERSISTENT_ROOT_SIZE, "the state of a heap must fit in PERSISTENT_ROOT_SIZE");
+
+/**
+ * Returns the strategy recorded with an index, since strategies are at different addresses in every program.
+ * @param index An index
+ * @return A strategy, or `NULL` if the index is unknown
+ */
+static fixed_buffer_strategy_t* persistent_strategies(uint32_t index)
+{
+    fixed_buffer_strategy_t* strategies[] = { FBS_FIRST_FIT, FBS_BEST_FIT, FBS_WORST_FIT, FBS_NEXT_FIT, FBS_TLSF };
+
+    return index < sizeof(strategies) / sizeof(strategies[0]) ? strategies[index] : NULL;
+}
+
+/**
+ * Returns the layout recorded with an index, since layouts are at different addresses in every program.
+ * @param index An index
+ * @return A layout, or `NULL` if the index is unknown
+ */
+static fixed_buffer_layout_t* persistent_layouts(uint32_t index)
+{
+    fixed_buffer_layout_t* layouts[] = { FBL_STANDARD, FBL_COMPACT };
+
+    return index < sizeof(layouts) / sizeof(layouts[0]) ? layouts[index] : NULL;
+}
+
+/**
+ * Maps a heap file, at the given address if it is free.
+ * @param file A file descriptor
+ * @param size The size of the file in bytes
+ * @param address The preferred address, or `NULL`
+ * @return The beginning of the mapping, or `NULL`
+ */
+static char* persistent_map(int file, size_t size, void* address)
+{
+    int flags = MAP_SHARED;
+
+#if defined(MAP_FIXED_NOREPLACE)
+    if (address != NULL)
+    {
+        void* base = mmap(address, size, PROT_READ | PROT_WRITE, flags | MAP_FIXED_NOREPLACE, file, 0);
+
+        if (base != MAP_FAILED)
+        {
+            return (char*) base;
+        }
+    }
+#endif
+
+    void* base = mmap(address, size, PROT_READ | PROT_WRITE, flags, file, 0);
+
+    return base != MAP_FAILED ? (char*) base : NULL;
+}
+
+bool persistent_allocator_touch(persistent_allocator_t* allocator)
+{
+    if (allocator->root->dirty != 0)
+    {
+        return true;
+    }
+
+    allocator->root->dirty = 1;
+
+    return msync(allocator->base, PERSISTENT_ROOT_SIZE, MS_SYNC) == 0;
+}
+
+/**
+ * Writes the whole heap to its file, flagged clean, and waits for it to be written.
+ * @param allocator A persistent allocator
+ * @return If the heap could be written
+ */
+static bool persistent_sync(persistent_allocator_t* allocator)
+{
+    // The root page can be written back at any time, so it is flagged clean only once the heap is on disk.  With pages
+    // larger than the root, the first page of the heap is written again along with the root.
+    long page_size = sysconf(_SC_PAGESIZE);
+    size_t heap = PERSISTENT_ROOT_SIZE & ~((size_t) (page_size > 0 ? page_size : 4096) - 1);
+
+    if (msync(allocator->base + heap, allocator->size - heap, MS_SYNC) != 0)
+    {
+        return false;
+    }
+
+    allocator->root->dirty = 0;
+
+    return msync(allocator->base, PERSISTENT_ROOT_SIZE, MS_SYNC) == 0;
+}
+
+/**
+ * Creates a new heap in an empty file.
+ * @param allocator A persistent allocator whose file is open
+ * @param size The size of the file in bytes
+ * @param strategy A strategy, or `NULL` for first fit
+ * @param layout A layout, or `NULL` for the standard layout
+ * @return If the file could be sized and mapped
+ */
+static bool persistent_create(
+    persistent_allocator_t* allocator,
+    size_t size,
+    fixed_buffer_strategy_t* strategy,
+    fixed_buffer_layout_t* layout
+)
+{
+    uint32_t strategy_index = 0;
+    uint32_t layout_index = 0;
+
+    while (strategy != NULL && persistent_strategies(strategy_index) != NULL && persistent_strategies(strategy_index) != strategy)
+    {
+        ++strategy_index;
+    }
+
+    while (layout != NULL && persistent_layouts(layout_index) != NULL && persistent_layouts(layout_index) != layout)
+    {
+        ++layout_index;
+    }
+
+    if (size <= PERSISTENT_ROOT_SIZE || persistent_strategies(strategy_index) == NULL || persistent_layouts(layout_index) == NULL)
+    {
+        return false;
+    }
+
+    if ((off_t) size < 0 || ftruncate(allocator->file, (off_t) size) != 0)
+    {
+        return false;
+    }
+
+    allocator->base = persistent_map(allocator->file, size, NULL);
+
+    if (allocator->base == NULL)
+    {
+        return false;
+    }
+
+    allocator->size = size;
+    allocator->root = (persistent_root_t*) allocator->base;
+
+    persistent_root_t* root = allocator->root;
+    root->magic = PERSISTENT_MAGIC;
+    root->version = PERSISTENT_VERSION;
+    root->strategy = strategy_index;
+    root->layout = layout_index;
+    root->size = size;
+    root->address = (uint64_t) (uintptr_t) allocator->base;
+    root->entry = 0;
+    root->heap = fixed_buffer_allocator_init_with_layout(
+        persistent_strategies(strategy_index),
+        persistent_layouts(layout_index),
+        allocator->base + PERSISTENT_ROOT_SIZE,
+        size - PERSISTENT_ROOT_SIZE
+    );
+    fixed_buffer_allocator_set_shared(&root->heap, true);
+
+    return persistent_sync(allocator);
+}
+
+/**
+ * Reattaches the heap of an existing file.
+ * @param allocator A persistent allocator whose file is open
+ * @param file_size The size of the file in bytes
+ * @return If the file holds a heap that was closed cleanly and could be mapped
+ */
+static bool persistent_reopen(persistent_allocator_t* allocator, size_t file_size)
+{
+    persistent_root_t root;
+
+    if (file_size < PERSISTENT_ROOT_SIZE || pread(allocator->file, &root, sizeof(persistent_root_t), 0) != (ssize_t) sizeof(persistent_root_t))
+    {
+        return false;
+    }
+
+    if (root.magic != PERSISTENT_MAGIC || root.version != PERSISTENT_VERSION || root.dirty != 0 || root.size != file_size
+        || persistent_strategies(root.strategy) == NULL || persistent_layouts(root.layout) == NULL)
+    {
+        return false;
+    }
+
+    allocator->base = persistent_map(allocator->file, file_size, (void*) (uintptr_t) root.address);
+
+    if (allocator->base == NULL)
+    {
+        return false;
+    }
+
+    allocator->size = file_size;
+    allocator->root = (persistent_root_t*) allocator->base;
+    allocator->relocated = (uintptr_t) allocator->base != root.address;
+
+    // Relocating rewrites the headers of the heap, which must not be mistaken for a consistent heap if interrupted.
+    if (allocator->relocated && !persistent_allocator_touch(allocator))
+    {
+        return false;
+    }
+
+    fixed_buffer_allocator_reattach(
+        &allocator->root->heap,
+        persistent_strategies(root.strategy),
+        persistent_layouts(root.layout),
+        allocator->base + PERSISTENT_ROOT_SIZE
+    );
+
+    // At the same address, only the pointers into the program changed, and they are rewritten whenever the file is opened.
+    if (!allocator->relocated)
+    {
+        return true;
+    }
+
+    allocator->root->address = (uint64_t) (uintptr_t) allocator->base;
+
+    return persistent_sync(allocator);
+}
+
+static void* persistent_allocator_reallocate(allocator_t* _allocator, void* memory, size_t size)
+{
+    persistent_allocator_t* allocator = FIELD_PARENT_PTR(persistent_allocator_t, allocator, _allocator);
+
+    if (!persistent_allocator_touch(allocator))
+    {
+        return NULL;
+    }
+
+    return reallocate(&allocator->root->heap.allocator, memory, size);
+}
+
+static void* persistent_allocator_reallocate_aligned(allocator_t* _allocator, void* memory, size_t size, size_t alignment)
+{
+    persistent_allocator_t* allocator = FIELD_PARENT_PTR(persistent_allocator_t, allocator, _allocator);
+
+    if (!persistent_allocator_touch(allocator))
+    {
+        return NULL;
+    }
+
+    return reallocate_aligned(&allocator->root->heap.allocator, memory, size, alignment);
+}
+
+static void persistent_allocator_deallocate_sized(allocator_t* _allocator, void* memory, size_t size)
+{
+    persistent_allocator_t* allocator = FIELD_PARENT_PTR(persistent_allocator_t, allocator, _allocator);
+
+    if (!persistent_allocator_touch(allocator))
+    {
+        return;
+    }
+
+    deallocate_sized(&allocator->root->heap.allocator, memory, size);
+}
+
+static size_t persistent_allocator_allocate_batch(allocator_t* _allocator, size_t size, size_t count, void** memories)
+{
+    persistent_allocator_t* allocator = FIELD_PARENT_PTR(persistent_allocator_t, allocator, _allocator);
+
+    if (!persistent_allocator_touch(allocator))
+    {
+        return 0;
+    }
+
+    return allocate_batch(&allocator->root->heap.allocator, size, count, memories);
+}
+
+static void persistent_allocator_deallocate_batch(allocator_t* _allocator, void** memories, size_t count)
+{
+    persistent_allocator_t* allocator = FIELD_PARENT_PTR(persistent_allocator_t, allocator, _allocator);
+
+    if (!persistent_allocator_touch(allocator))
+    {
+        return;
+    }
+
+    deallocate_batch(&allocator->root->heap.allocator, memories, count);
+}
+
+static const allocator_t persistent_allocator_vtable = {
+    persistent_allocator_reallocate,
+    persistent_allocator_reallocate_aligned,
+    persistent_allocator_deallocate_sized,
+    persistent_allocator_allocate_batch,
+    persistent_allocator_deallocate_batch,
+};
+
+bool persistent_allocator_open(
+    persistent_allocator_t* allocator,
+    const char* path,
+    size_t size,
+    fixed_buffer_strategy_t* strategy,
+    fixed_buffer_layout_t* layout
+)
+{
+    allocator->allocator = persistent_allocator_vtable;
+    allocator->base = NULL;
+    allocator->size = 0;
+    allocator->root = NULL;
+    allocator->relocated = false;
+    allocator->file = open(path, O_RDWR | O_CREAT, 0600);
+
+    if (allocator->file < 0)
+    {
+        return false;
+    }
+
+    struct stat status;
+    bool opened = fstat(allocator->file, &status) == 0 && (status.st_size == 0
+        ? persistent_create(allocator, size, strategy, layout)
+        : persistent_reopen(allocator, (size_t) status.st_size));
+
+    if (!opened)
+    {
+        if (allocator->base != NULL)
+        {
+            munmap(allocator->base, allocator->size);
+        }
+
+        close(allocator->file);
+        allocator->file = -1;
+        allocator->base = NULL;
+        allocator->root = NULL;
+    }
+
+    return opened;
+}
+
+bool persistent_allocator_checkpoint(persistent_allocator_t* allocator)
+{
+    // The flag is set again by the next modification of the heap, so a file left alone after a checkpoint stays clean.
+    return persistent_sync(allocator);
+}
+
+bool persistent_allocator_close(persistent_allocator_t* allocator)
+{
+    bool written = persistent_sync(allocator);
+
+    munmap(allocator->base, allocator->size);
+    close(allocator->file);
+
+    allocator->file = -1;
+    allocator->base = NULL;
+    allocator->root = NULL;
+
+    return written;
+}
+
+size_t persistent_allocator_offset(persistent_allocator_t* allocator, void* memory)
+{
+    return memory != NULL ? (size_t) ((char*) memory - allocator->base) : 0;
+}
+
+void* persistent_allocator_pointer(persistent_allocator_t* allocator, size_t offset)
+{
+    return offset != 0 ? allocator->base + offset : NULL;
+}
+
+void* persistent_allocator_get_root(persistent_allocator_t* allocator)
+{
+    return persistent_allocator_pointer(allocator, (size_t) allocator->root->entry);
+}
+
+void persistent_allocator_set_root(persistent_allocator_t* allocator, void* memory)
+{
+    persistent_allocator_touch(allocator);
+    allocator->root->entry = (uint64_t) persistent_allocator_offset(allocator, memory);
+}
@@ -0,0 +1,166 @@
+#include "allocators/pool_allocator.h"
+
+#include <stdint.h>
+
+#include "./macros.h"
+
+/**
+ * The alignment of slabs, suitable for any fundamental type.
+ */
+#define POOL_ALIGNMENT ((size_t) _Alignof(max_align_t))
+
+/**
+ * The size of the header of a slab, keeping the blocks following it aligned.
+ */
+#define POOL_SLAB_HEADER_SIZE ((sizeof(pool_slab_t) + POOL_ALIGNMENT - 1) & ~(POOL_ALIGNMENT - 1))
+
+struct pool_slab {
+    /**
+     * The following slab, or `NULL` for the last one.
+     */
+    struct pool_slab* next;
+};
+
+/**
+ * Returns the size in bytes of a slab, header included.
+ * @param allocator A pool allocator
+ * @return A size in bytes
+ */
+static size_t pool_allocator_slab_size(pool_allocator_t* allocator)
+{
+    return POOL_SLAB_HEADER_SIZE + allocator->block_size * allocator->slab_count;
+}
+
+bool pool_allocator_grow(pool_allocator_t* allocator)
+{
+    if (allocator->slab_count == 0 || allocator->block_size > (SIZE_MAX - POOL_SLAB_HEADER_SIZE) / allocator->slab_count)
+    {
+        return false;
+    }
+
+    pool_slab_t* slab = allocate_aligned(allocator->parent, pool_allocator_slab_size(allocator), POOL_ALIGNMENT);
+
+    if (slab == NULL)
+    {
+        return false;
+    }
+
+    slab->next = allocator->slabs;
+    allocator->slabs = slab;
+
+    char* blocks = (char*) slab + POOL_SLAB_HEADER_SIZE;
+
+    // Blocks are linked from the end, so that they are handed out in address order.
+    for (size_t i = allocator->slab_count; i > 0; --i)
+    {
+        pool_block_t* block = (pool_block_t*) (blocks + (i - 1) * allocator->block_size);
+        block->next = allocator->free;
+        allocator->free = block;
+    }
+
+    return true;
+}
+
+static void* pool_allocator_reallocate(allocator_t* _allocator, void* memory, size_t size)
+{
+    pool_allocator_t* allocator = FIELD_PARENT_PTR(pool_allocator_t, allocator, _allocator);
+
+    if (memory == NULL && size == 0)
+    {
+        return NULL;
+    }
+    // No memory, but a size given, pop a block from the free list.
+    else if (memory == NULL)
+    {
+        if (size > allocator->block_size)
+        {
+            return NULL;
+        }
+
+        if (allocator->free == NULL && !pool_allocator_grow(allocator))
+        {
+            return NULL;
+        }
+
+        pool_block_t* block = allocator->free;
+        allocator->free = block->next;
+
+        return block;
+    }
+    // Memory is not null, push it back on the free list.
+    else if (size == 0)
+    {
+        pool_block_t* block = (pool_block_t*) memory;
+        block->next = allocator->free;
+        allocator->free = block;
+
+        return NULL;
+    }
+    // All blocks have the same size, so a resize either fits in place or fails.
+    else
+    {
+        return size <= allocator->block_size ? memory : NULL;
+    }
+}
+
+bool pool_allocator_holds(pool_allocator_t* allocator, size_t size, size_t alignment)
+{
+    // Blocks follow each other from the end of an aligned slab header, so they are only aligned as much as their size.
+    return size <= allocator->block_size && ((POOL_ALIGNMENT | allocator->block_size) & (alignment - 1)) == 0;
+}
+
+static void* pool_allocator_reallocate_aligned(allocator_t* _allocator, void* memory, size_t size, size_t alignment)
+{
+    pool_allocator_t* allocator = FIELD_PARENT_PTR(pool_allocator_t, allocator, _allocator);
+
+    if (!pool_allocator_holds(allocator, 1, alignment))
+    {
+        return NULL;
+    }
+
+    return pool_allocator_reallocate(_allocator, memory, size);
+}
+
+static const allocator_t pool_allocator_vtable = {
+    pool_allocator_reallocate,
+    pool_allocator_reallocate_aligned,
+    NULL,
+    NULL,
+    NULL,
+};
+
+pool_allocator_t pool_allocator_init(allocator_t* parent, size_t block_size, size_t slab_count)
+{
+    // Free blocks hold a link, and rounding to its size keeps blocks aligned for pointers too.
+    if (block_size < sizeof(pool_block_t))
+    {
+        block_size = sizeof(pool_block_t);
+    }
+
+    block_size = (block_size + sizeof(pool_block_t) - 1) & ~(sizeof(pool_block_t) - 1);
+
+    pool_allocator_t allocator;
+    allocator.allocator = pool_allocator_vtable;
+    allocator.parent = parent;
+    allocator.block_size = block_size;
+    allocator.slab_count = slab_count;
+    allocator.free = NULL;
+    allocator.slabs = NULL;
+
+    return allocator;
+}
+
+void pool_allocator_deinit(pool_allocator_t* allocator)
+{
+    pool_slab_t* slab = allocator->slabs;
+
+    while (slab != NULL)
+    {
+        pool_slab_t* next = slab->next;
+        deallocate_sized(allocator->parent, slab, pool_allocator_slab_size(allocator));
+        slab = next;
+    }
+
+    allocator->free = NULL;
+    allocator->slabs = NULL;
+}
@@ -0,0 +1,458 @@
+#if !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include "allocators/shared_allocator.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "./macros.h"
+
+/**
+ * The tag at the beginning of every shared region, written last when the heap is ready.
+ */
+#define SHARED_MAGIC UINT64_C(0x5348524448454150)
+
+/**
+ * The version of the format of shared regions, to be incremented whenever `shared_region_t` or the layout of the heap
+ * changes.
+ */
+#define SHARED_VERSION 2
+
+struct shared_region {
+    _Atomic(uint64_t) magic;
+    uint32_t version;
+    /**
+     * Nonzero once a process died while holding the lock.
+     */
+    _Atomic(uint32_t) damaged;
+    /**
+     * The index of the strategy of the heap in `shared_strategies/1`.
+     */
+    uint32_t strategy;
+    /**
+     * The index of the layout of the heap in `shared_layouts/1`.
+     */
+    uint32_t layout;
+    /**
+     * The size of the region in bytes.
+     */
+    uint64_t size;
+    /**
+     * The address at which every process maps the region.
+     */
+    uint64_t address;
+    pthread_mutex_t lock;
+    /**
+     * The state of the heap.  Its pointers to the strategy and the layout are those of the last process holding the
+     * lock.
+     */
+    fixed_buffer_allocator_t heap;
+};
+
+_Static_assert(sizeof(shared_region_t) <= SHARED_HEADER_SIZE, "the state of a heap must fit in SHARED_HEADER_SIZE");
+
+/**
+ * Returns the strategy recorded with an index, since strategies are at different addresses in every program.
+ * @param index An index
+ * @return A strategy, or `NULL` if the index is unknown
+ */
+static fixed_buffer_strategy_t* shared_strategies(uint32_t index)
+{
+    fixed_buffer_strategy_t* strategies[] = { FBS_FIRST_FIT, FBS_BEST_FIT, FBS_WORST_FIT, FBS_NEXT_FIT, FBS_TLSF };
+
+    return index < sizeof(strategies) / sizeof(strategies[0]) ? strategies[index] : NULL;
+}
+
+/**
+ * Returns the layout recorded with an index, since layouts are at different addresses in every program.
+ * @param index An index
+ * @return A layout, or `NULL` if the index is unknown
+ */
+static fixed_buffer_layout_t* shared_layouts(uint32_t index)
+{
+    fixed_buffer_layout_t* layouts[] = { FBL_STANDARD, FBL_COMPACT };
+
+    return index < sizeof(layouts) / sizeof(layouts[0]) ? layouts[index] : NULL;
+}
+
+/**
+ * Maps a shared region, exactly at the given address if there is one.
+ * @param file A file descriptor
+ * @param size The size of the region in bytes
+ * @param address The required address, or `NULL` for any address
+ * @return The beginning of the mapping, or `NULL`
+ */
+static char* shared_map(int file, size_t size, void* address)
+{
+    int flags = MAP_SHARED;
+
+#if defined(MAP_FIXED_NOREPLACE)
+    if (address != NULL)
+    {
+        flags |= MAP_FIXED_NOREPLACE;
+    }
+#endif
+
+    void* base = mmap(address, size, PROT_READ | PROT_WRITE, flags, file, 0);
+
+    if (base == MAP_FAILED)
+    {
+        return NULL;
+    }
+
+    // Without MAP_FIXED_NOREPLACE, or on kernels ignoring it, the address is only a hint.
+    if (address != NULL && base != address)
+    {
+        munmap(base, size);
+        return NULL;
+    }
+
+    return (char*) base;
+}
+
+/**
+ * Initializes a process-shared robust mutex.
+ * @param lock A mutex in shared memory
+ * @return If the mutex could be initialized
+ */
+static bool shared_lock_init(pthread_mutex_t* lock)
+{
+    pthread_mutexattr_t attributes;
+
+    if (pthread_mutexattr_init(&attributes) != 0)
+    {
+        return false;
+    }
+
+    bool initialized = pthread_mutexattr_setpshared(&attributes, PTHREAD_PROCESS_SHARED) == 0
+        && pthread_mutexattr_setrobust(&attributes, PTHREAD_MUTEX_ROBUST) == 0
+        && pthread_mutex_init(lock, &attributes) == 0;
+
+    pthread_mutexattr_destroy(&attributes);
+
+    return initialized;
+}
+
+/**
+ * Locks a shared heap and points its state at the strategy and the layout of this process.
+ * @param allocator A shared allocator
+ * @return If the lock was taken and the heap is not damaged, in which case it must be unlocked
+ */
+static bool shared_lock(shared_allocator_t* allocator)
+{
+    shared_region_t* region = allocator->region;
+    int status = pthread_mutex_lock(&region->lock);
+
+    // The previous owner died, maybe halfway through an update, so the heap cannot be trusted anymore.
+    if (status == EOWNERDEAD)
+    {
+        atomic_store(&region->damaged, 1);
+        pthread_mutex_consistent(&region->lock);
+    }
+    else if (status != 0)
+    {
+        atomic_store(&region->damaged, 1);
+        return false;
+    }
+
+    if (atomic_load(&region->damaged) != 0)
+    {
+        pthread_mutex_unlock(&region->lock);
+        return false;
+    }
+
+    // The buffer is where the state expects it, so this only swaps the pointers into the program.
+    fixed_buffer_allocator_reattach(
+        &region->heap,
+        shared_strategies(region->strategy),
+        shared_layouts(region->layout),
+        allocator->base + SHARED_HEADER_SIZE
+    );
+
+    return true;
+}
+
+static void* shared_allocator_reallocate(allocator_t* _allocator, void* memory, size_t size)
+{
+    shared_allocator_t* allocator = FIELD_PARENT_PTR(shared_allocator_t, allocator, _allocator);
+
+    if (!shared_lock(allocator))
+    {
+        return NULL;
+    }
+
+    void* new_memory = reallocate(&allocator->region->heap.allocator, memory, size);
+
+    pthread_mutex_unlock(&allocator->region->lock);
+
+    return new_memory;
+}
+
+static void* shared_allocator_reallocate_aligned(allocator_t* _allocator, void* memory, size_t size, size_t alignment)
+{
+    shared_allocator_t* allocator = FIELD_PARENT_PTR(shared_allocator_t, allocator, _allocator);
+
+    if (!shared_lock(allocator))
+    {
+        return NULL;
+    }
+
+    void* new_memory = reallocate_aligned(&allocator->region->heap.allocator, memory, size, alignment);
+
+    pthread_mutex_unlock(&allocator->region->lock);
+
+    return new_memory;
+}
+
+static void shared_allocator_deallocate_sized(allocator_t* _allocator, void* memory, size_t size)
+{
+    shared_allocator_t* allocator = FIELD_PARENT_PTR(shared_allocator_t, allocator, _allocator);
+
+    if (!shared_lock(allocator))
+    {
+        return;
+    }
+
+    deallocate_sized(&allocator->region->heap.allocator, memory, size);
+
+    pthread_mutex_unlock(&allocator->region->lock);
+}
+
+static size_t shared_allocator_allocate_batch(allocator_t* _allocator, size_t size, size_t count, void** memories)
+{
+    shared_allocator_t* allocator = FIELD_PARENT_PTR(shared_allocator_t, allocator, _allocator);
+
+    if (!shared_lock(allocator))
+    {
+        return 0;
+    }
+
+    size_t allocated = allocate_batch(&allocator->region->heap.allocator, size, count, memories);
+
+    pthread_mutex_unlock(&allocator->region->lock);
+
+    return allocated;
+}
+
+static void shared_allocator_deallocate_batch(allocator_t* _allocator, void** memories, size_t count)
+{
+    shared_allocator_t* allocator = FIELD_PARENT_PTR(shared_allocator_t, allocator, _allocator);
+
+    if (!shared_lock(allocator))
+    {
+        return;
+    }
+
+    deallocate_batch(&allocator->region->heap.allocator, memories, count);
+
+    pthread_mutex_unlock(&allocator->region->lock);
+}
+
+static const allocator_t shared_allocator_vtable = {
+    shared_allocator_reallocate,
+    shared_allocator_reallocate_aligned,
+    shared_allocator_deallocate_sized,
+    shared_allocator_allocate_batch,
+    shared_allocator_deallocate_batch,
+};
+
+/**
+ * Resets a shared allocator before it is created or attached.
+ * @param allocator A shared allocator
+ */
+static void shared_allocator_reset(shared_allocator_t* allocator)
+{
+    allocator->allocator = shared_allocator_vtable;
+    allocator->file = -1;
+    allocator->base = NULL;
+    allocator->size = 0;
+    allocator->region = NULL;
+}
+
+bool shared_allocator_create(
+    shared_allocator_t* allocator,
+    const char* name,
+    size_t size,
+    fixed_buffer_strategy_t* strategy,
+    fixed_buffer_layout_t* layout
+)
+{
+    shared_allocator_reset(allocator);
+
+    uint32_t strategy_index = 0;
+    uint32_t layout_index = 0;
+
+    while (strategy != NULL && shared_strategies(strategy_index) != NULL && shared_strategies(strategy_index) != strategy)
+    {
+        ++strategy_index;
+    }
+
+    while (layout != NULL && shared_layouts(layout_index) != NULL && shared_layouts(layout_index) != layout)
+    {
+        ++layout_index;
+    }
+
+    if (size <= SHARED_HEADER_SIZE || (off_t) size < 0 || shared_strategies(strategy_index) == NULL || shared_layouts(layout_index) == NULL)
+    {
+        return false;
+    }
+
+    allocator->file = name != NULL ? shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600) : memfd_create("shared_allocator", 0);
+
+    if (allocator->file < 0)
+    {
+        return false;
+    }
+
+    if (ftruncate(allocator->file, (off_t) size) != 0 || (allocator->base = shared_map(allocator->file, size, NULL)) == NULL)
+    {
+        close(allocator->file);
+
+        if (name != NULL)
+        {
+            shm_unlink(name);
+        }
+
+        shared_allocator_reset(allocator);
+        return false;
+    }
+
+    allocator->size = size;
+    allocator->region = (shared_region_t*) allocator->base;
+
+    shared_region_t* region = allocator->region;
+    region->version = SHARED_VERSION;
+    region->strategy = strategy_index;
+    region->layout = layout_index;
+    region->size = size;
+    region->address = (uint64_t) (uintptr_t) allocator->base;
+    region->heap = fixed_buffer_allocator_init_with_layout(
+        shared_strategies(strategy_index),
+        shared_layouts(layout_index),
+        allocator->base + SHARED_HEADER_SIZE,
+        size - SHARED_HEADER_SIZE
+    );
+    fixed_buffer_allocator_set_shared(&region->heap, true);
+    atomic_init(&region->damaged, 0);
+
+    if (!shared_lock_init(&region->lock))
+    {
+        shared_allocator_detach(allocator);
+
+        if (name != NULL)
+        {
+            shm_unlink(name);
+        }
+
+        return false;
+    }
+
+    // Processes attaching meanwhile see no magic yet, and give up instead of using a heap being initialized.
+    atomic_store_explicit(&region->magic, SHARED_MAGIC, memory_order_release);
+
+    return true;
+}
+
+bool shared_allocator_attach(shared_allocator_t* allocator, int file)
+{
+    shared_allocator_reset(allocator);
+
+    shared_region_t region;
+    struct stat status;
+
+    if (fstat(file, &status) != 0 || (size_t) status.st_size < sizeof(shared_region_t)
+        || pread(file, &region, sizeof(shared_region_t), 0) != (ssize_t) sizeof(shared_region_t))
+    {
+        return false;
+    }
+
+    if (atomic_load(&region.magic) != SHARED_MAGIC || region.version != SHARED_VERSION || region.size != (uint64_t) status.st_size
+        || shared_strategies(region.strategy) == NULL || shared_layouts(region.layout) == NULL)
+    {
+        return false;
+    }
+
+    allocator->file = dup(file);
+
+    if (allocator->file < 0)
+    {
+        return false;
+    }
+
+    allocator->base = shared_map(allocator->file, (size_t) region.size, (void*) (uintptr_t) region.address);
+
+    if (allocator->base == NULL)
+    {
+        close(allocator->file);
+        shared_allocator_reset(allocator);
+        return false;
+    }
+
+    allocator->size = (size_t) region.size;
+    allocator->region = (shared_region_t*) allocator->base;
+
+    // Pairs with the release in `shared_allocator_create/5`, so that the initialized heap is visible.
+    if (atomic_load_explicit(&allocator->region->magic, memory_order_acquire) != SHARED_MAGIC)
+    {
+        shared_allocator_detach(allocator);
+        return false;
+    }
+
+    return true;
+}
+
+bool shared_allocator_open(shared_allocator_t* allocator, const char* name)
+{
+    int file = shm_open(name, O_RDWR, 0);
+
+    if (file < 0)
+    {
+        shared_allocator_reset(allocator);
+        return false;
+    }
+
+    bool attached = shared_allocator_attach(allocator, file);
+
+    close(file);
+
+    return attached;
+}
+
+void shared_allocator_detach(shared_allocator_t* allocator)
+{
+    if (allocator->base != NULL)
+    {
+        munmap(allocator->base, allocator->size);
+    }
+
+    if (allocator->file >= 0)
+    {
+        close(allocator->file);
+    }
+
+    shared_allocator_reset(allocator);
+}
+
+size_t shared_allocator_offset(shared_allocator_t* allocator, void* memory)
+{
+    return memory != NULL ? (size_t) ((char*) memory - allocator->base) : 0;
+}
+
+void* shared_allocator_pointer(shared_allocator_t* allocator, size_t offset)
+{
+    return offset != 0 ? allocator->base + offset : NULL;
+}
+
+bool shared_allocator_is_damaged(shared_allocator_t* allocator)
+{
+    // A heap that could not be created or attached, or was detached, has no region to be damaged.
+    return allocator->region != NULL && atomic_load(&allocator->region->damaged) != 0;
+}
@@ -0,0 +1,196 @@
+#include "allocators/stack_allocator.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include "./macros.h"
+
+/**
+ * The alignment of all blocks.
+ */
+#define STACK_ALIGNMENT ((size_t) 8)
+
+/**
+ * The flag set in the size of a block freed while other blocks were above it.
+ */
+#define STACK_FREED ((size_t) 1)
+
+/**
+ * The header in front of every block.
+ */
+typedef struct stack_header {
+    /**
+     * The memory of the block below this one, or `NULL` for the bottom block.
+     */
+    char* previous;
+    /**
+     * The size of the block in bytes, a multiple of `STACK_ALIGNMENT`, or'ed with `STACK_FREED`.
+     */
+    size_t size;
+} stack_header_t;
+
+/**
+ * Returns the header of a block.
+ * @param memory The memory of a block
+ * @return A header
+ */
+static stack_header_t* stack_header(char* memory)
+{
+    return (stack_header_t*) (memory - sizeof(stack_header_t));
+}
+
+/**
+ * Pops the top block, then the blocks under it which were already freed.
+ * @param allocator A stack allocator whose stack is not empty
+ */
+static void stack_pop(stack_allocator_t* allocator)
+{
+    // The padding below the header of a block is reclaimed along with the block under it.
+    do
+    {
+        char* memory = allocator->last;
+        allocator->last = stack_header(memory)->previous;
+        allocator->top = allocator->last != NULL ? (char*) stack_header(memory) : (char*) allocator->buffer;
+    }
+    while (allocator->last != NULL && (stack_header(allocator->last)->size & STACK_FREED) != 0);
+}
+
+/**
+ * Frees a block, popping it if it is on top of the stack, or flagging it to be popped with the blocks above it.
+ * @param allocator A stack allocator
+ * @param memory A block
+ */
+static void stack_free(stack_allocator_t* allocator, char* memory)
+{
+    if (memory == allocator->last)
+    {
+        stack_pop(allocator);
+    }
+    else
+    {
+        stack_header(memory)->size |= STACK_FREED;
+    }
+}
+
+/**
+ * Rounds a pointer up to an alignment.
+ * @param pointer A pointer
+ * @param alignment A power of two
+ * @return The aligned pointer
+ */
+static char* stack_align(char* pointer, size_t alignment)
+{
+    return pointer + (size_t) (-(uintptr_t) pointer & (alignment - 1));
+}
+
+static void* stack_allocator_reallocate_aligned(allocator_t* _allocator, void* _memory, size_t size, size_t alignment)
+{
+    stack_allocator_t* allocator = FIELD_PARENT_PTR(stack_allocator_t, allocator, _allocator);
+    char* memory = (char*) _memory;
+    char* end = (char*) allocator->buffer + allocator->size;
+
+    if (alignment < STACK_ALIGNMENT)
+    {
+        alignment = STACK_ALIGNMENT;
+    }
+
+    if (size == 0)
+    {
+        if (memory != NULL)
+        {
+            stack_free(allocator, memory);
+        }
+
+        return NULL;
+    }
+
+    // This also protects the rounding of the size against overflows.
+    if (size > allocator->size)
+    {
+        return NULL;
+    }
+
+    size = (size + STACK_ALIGNMENT - 1) & ~(STACK_ALIGNMENT - 1);
+
+    // The top block is followed by free memory, so it can be resized in place.
+    if (
+        memory != NULL
+        && memory == allocator->last
+        && ((uintptr_t) memory & (alignment - 1)) == 0
+        && size <= (size_t) (end - memory)
+    )
+    {
+        stack_header(memory)->size = size;
+        allocator->top = memory + size;
+        return memory;
+    }
+
+    char* new_memory = stack_align(allocator->top + sizeof(stack_header_t), alignment);
+
+    if (new_memory > end || size > (size_t) (end - new_memory))
+    {
+        return NULL;
+    }
+
+    stack_header(new_memory)->previous = allocator->last;
+    stack_header(new_memory)->size = size;
+
+    allocator->top = new_memory + size;
+    allocator->last = new_memory;
+
+    // The old block is below the new one, so it is only flagged freed, and popped along with the new block.
+    if (memory != NULL)
+    {
+        size_t old_size = stack_header(memory)->size;
+        memcpy(new_memory, memory, old_size < size ? old_size : size);
+        stack_header(memory)->size |= STACK_FREED;
+    }
+
+    return new_memory;
+}
+
+static void* stack_allocator_reallocate(allocator_t* allocator, void* memory, size_t size)
+{
+    return stack_allocator_reallocate_aligned(allocator, memory, size, STACK_ALIGNMENT);
+}
+
+static const allocator_t stack_allocator_vtable = {
+    stack_allocator_reallocate,
+    stack_allocator_reallocate_aligned,
+    NULL,
+    NULL,
+    NULL,
+};
+
+stack_allocator_t stack_allocator_init(void* buffer, size_t size)
+{
+    stack_allocator_t allocator;
+    allocator.allocator = stack_allocator_vtable;
+    allocator.buffer = buffer;
+    allocator.size = size;
+    allocator.top = (char*) buffer;
+    allocator.last = NULL;
+
+    return allocator;
+}
+
+stack_frame_t stack_push_frame(stack_allocator_t* allocator)
+{
+    stack_frame_t frame;
+    frame.top = allocator->top;
+    frame.last = allocator->last;
+
+    return frame;
+}
+
+void stack_pop_frame(stack_allocator_t* allocator, stack_frame_t frame)
+{
+    allocator->top = frame.top;
+    allocator->last = frame.last;
+
+    // Blocks below the frame freed while it was active are reclaimed now that they are on top.
+    if (allocator->last != NULL && (stack_header(allocator->last)->size & STACK_FREED) != 0)
+    {
+        stack_pop(allocator);
+    }
+}
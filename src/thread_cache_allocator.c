@@ -0,0 +1,464 @@
+#include "allocators/thread_cache_allocator.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include "./macros.h"
+
+/**
+ * The size of the header in front of every block, keeping the alignment given by the parent allocator.
+ */
+#define THREAD_CACHE_HEADER_SIZE ((size_t) _Alignof(max_align_t))
+
+/**
+ * The size of the largest size class.
+ */
+#define THREAD_CACHE_MAX_SIZE ((size_t) 1 << (THREAD_CACHE_MIN_ORDER + THREAD_CACHE_CLASS_COUNT - 1))
+
+struct thread_cache {
+    /**
+     * The allocator owning this cache.
+     */
+    thread_cache_allocator_t* allocator;
+    /**
+     * The number of blocks cached in every size class.
+     */
+    size_t counts[THREAD_CACHE_CLASS_COUNT];
+    /**
+     * The memory of the blocks cached in every size class.
+     */
+    void* blocks[THREAD_CACHE_CLASS_COUNT][THREAD_CACHE_CAPACITY];
+    /**
+     * The counters of this thread, added to those of the allocator when the thread exits.
+     */
+    thread_cache_stats_t stats;
+};
+
+/**
+ * Returns the size class of a size.
+ * @param size A size in bytes, at most `THREAD_CACHE_MAX_SIZE`
+ * @return An index
+ */
+static unsigned thread_cache_class(size_t size)
+{
+    unsigned index = 0;
+
+    while (((size_t) 1 << (THREAD_CACHE_MIN_ORDER + index)) < size)
+    {
+        ++index;
+    }
+
+    return index;
+}
+
+/**
+ * Returns the size of the blocks of a size class.
+ * @param index A size class
+ * @return A size in bytes
+ */
+static size_t thread_cache_class_size(unsigned index)
+{
+    return (size_t) 1 << (THREAD_CACHE_MIN_ORDER + index);
+}
+
+/**
+ * Returns the size written in the header of a block.
+ * @param memory The memory of a block
+ * @return A size in bytes
+ */
+static size_t* thread_cache_header(void* memory)
+{
+    return (size_t*) ((char*) memory - THREAD_CACHE_HEADER_SIZE);
+}
+
+/**
+ * Adds counters to others.
+ * @param stats Counters
+ * @param other Counters to add
+ */
+static void thread_cache_stats_add(thread_cache_stats_t* stats, thread_cache_stats_t* other)
+{
+    stats->allocation_hits += other->allocation_hits;
+    stats->allocation_misses += other->allocation_misses;
+    stats->deallocation_hits += other->deallocation_hits;
+    stats->deallocation_misses += other->deallocation_misses;
+    stats->uncached += other->uncached;
+}
+
+/**
+ * Gives the last `count` cached blocks of a size class back to the parent allocator.  The lock must be held.
+ * @param cache A cache
+ * @param index A size class
+ * @param count A number of blocks
+ */
+static void thread_cache_release(thread_cache_t* cache, unsigned index, size_t count)
+{
+    void** blocks = &cache->blocks[index][cache->counts[index] - count];
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        blocks[i] = thread_cache_header(blocks[i]);
+    }
+
+    deallocate_batch(cache->allocator->parent, blocks, count);
+    cache->counts[index] -= count;
+}
+
+/**
+ * Gives all the blocks of a cache back to the parent allocator.  The lock must be held.
+ * @param cache A cache
+ */
+static void thread_cache_release_all(thread_cache_t* cache)
+{
+    for (unsigned index = 0; index < THREAD_CACHE_CLASS_COUNT; ++index)
+    {
+        thread_cache_release(cache, index, cache->counts[index]);
+    }
+}
+
+/**
+ * Flushes the cache of an exiting thread and frees it.
+ * @param data A cache
+ */
+static void thread_cache_destroy(void* data)
+{
+    thread_cache_t* cache = (thread_cache_t*) data;
+    thread_cache_allocator_t* allocator = cache->allocator;
+
+    mtx_lock(&allocator->lock);
+    thread_cache_release_all(cache);
+    thread_cache_stats_add(&allocator->stats, &cache->stats);
+    deallocate(allocator->parent, cache);
+    mtx_unlock(&allocator->lock);
+}
+
+/**
+ * Returns the cache of the calling thread, creating it on first use.
+ * @param allocator A thread cache allocator
+ * @return A cache, or `NULL` if it could not be allocated
+ */
+static thread_cache_t* thread_cache_get(thread_cache_allocator_t* allocator)
+{
+    thread_cache_t* cache = (thread_cache_t*) tss_get(allocator->caches);
+
+    if (cache != NULL)
+    {
+        return cache;
+    }
+
+    mtx_lock(&allocator->lock);
+    cache = create(allocator->parent, thread_cache_t);
+    mtx_unlock(&allocator->lock);
+
+    if (cache == NULL)
+    {
+        return NULL;
+    }
+
+    memset(cache, 0, sizeof(thread_cache_t));
+    cache->allocator = allocator;
+
+    if (tss_set(allocator->caches, cache) != thrd_success)
+    {
+        mtx_lock(&allocator->lock);
+        destroy(allocator->parent, cache);
+        mtx_unlock(&allocator->lock);
+
+        return NULL;
+    }
+
+    return cache;
+}
+
+/**
+ * Allocates a block directly from the parent allocator, because it is too large to be cached or because the calling
+ * thread has no cache.
+ * @param allocator A thread cache allocator
+ * @param cache The cache of the calling thread, or `NULL`
+ * @param size A size in bytes
+ * @return The memory of the block, or `NULL`
+ */
+static void* thread_cache_allocate_uncached(
+    thread_cache_allocator_t* allocator,
+    thread_cache_t* cache,
+    size_t size,
+    size_t alignment
+)
+{
+    if (size > SIZE_MAX - THREAD_CACHE_HEADER_SIZE)
+    {
+        return NULL;
+    }
+
+    // Small blocks may still be freed into the cache of another thread, which hands them out for their whole class.
+    if (size <= THREAD_CACHE_MAX_SIZE)
+    {
+        size = thread_cache_class_size(thread_cache_class(size));
+    }
+
+    // The header keeps the alignment of the block for the memory following it, since it is at least as large.
+    mtx_lock(&allocator->lock);
+    char* block = alignment > 1
+        ? allocate_aligned(allocator->parent, THREAD_CACHE_HEADER_SIZE + size, alignment)
+        : allocate(allocator->parent, THREAD_CACHE_HEADER_SIZE + size);
+    mtx_unlock(&allocator->lock);
+
+    if (block == NULL)
+    {
+        return NULL;
+    }
+
+    if (cache != NULL)
+    {
+        cache->stats.uncached++;
+    }
+
+    *(size_t*) block = size;
+
+    return block + THREAD_CACHE_HEADER_SIZE;
+}
+
+/**
+ * Allocates a block, from the cache of the calling thread when possible.
+ * @param allocator A thread cache allocator
+ * @param size A size in bytes
+ * @return The memory of the block, or `NULL`
+ */
+static void* thread_cache_allocate(thread_cache_allocator_t* allocator, size_t size)
+{
+    thread_cache_t* cache = thread_cache_get(allocator);
+
+    if (cache == NULL || size > THREAD_CACHE_MAX_SIZE)
+    {
+        return thread_cache_allocate_uncached(allocator, cache, size, 1);
+    }
+
+    unsigned index = thread_cache_class(size);
+
+    if (cache->counts[index] != 0)
+    {
+        cache->stats.allocation_hits++;
+        return cache->blocks[index][--cache->counts[index]];
+    }
+
+    // The cache is empty, so a batch of blocks is taken from the parent allocator.
+    size_t class_size = thread_cache_class_size(index);
+    void** blocks = cache->blocks[index];
+
+    mtx_lock(&allocator->lock);
+    size_t count = allocate_batch(allocator->parent, THREAD_CACHE_HEADER_SIZE + class_size, THREAD_CACHE_BATCH, blocks);
+    mtx_unlock(&allocator->lock);
+
+    if (count == 0)
+    {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        *(size_t*) blocks[i] = class_size;
+        blocks[i] = (char*) blocks[i] + THREAD_CACHE_HEADER_SIZE;
+    }
+
+    cache->stats.allocation_misses++;
+    cache->counts[index] = count - 1;
+
+    return blocks[count - 1];
+}
+
+/**
+ * Deallocates a block, keeping it in the cache of the calling thread when possible.
+ * @param allocator A thread cache allocator
+ * @param memory The memory of a block
+ */
+static void thread_cache_deallocate(thread_cache_allocator_t* allocator, void* memory)
+{
+    size_t size = *thread_cache_header(memory);
+    thread_cache_t* cache = thread_cache_get(allocator);
+
+    if (cache == NULL || size > THREAD_CACHE_MAX_SIZE)
+    {
+        if (cache != NULL)
+        {
+            cache->stats.uncached++;
+        }
+
+        mtx_lock(&allocator->lock);
+        deallocate(allocator->parent, thread_cache_header(memory));
+        mtx_unlock(&allocator->lock);
+
+        return;
+    }
+
+    unsigned index = thread_cache_class(size);
+
+    // The cache is full, so a batch of blocks goes back to the parent allocator.
+    if (cache->counts[index] == THREAD_CACHE_CAPACITY)
+    {
+        mtx_lock(&allocator->lock);
+        thread_cache_release(cache, index, THREAD_CACHE_BATCH);
+        mtx_unlock(&allocator->lock);
+
+        cache->stats.deallocation_misses++;
+    }
+    else
+    {
+        cache->stats.deallocation_hits++;
+    }
+
+    cache->blocks[index][cache->counts[index]++] = memory;
+}
+
+/**
+ * Allocates a block whose memory has the given alignment.  Cached blocks only have the alignment given by the parent
+ * allocator, so aligned blocks come from the parent directly, and are cached like any other block once freed.
+ * @param allocator A thread cache allocator
+ * @param size A size in bytes
+ * @param alignment A power of two, at most `THREAD_CACHE_HEADER_SIZE`, or 1 for no alignment
+ * @return The memory of the block, or `NULL`
+ */
+static void* thread_cache_allocate_aligned(thread_cache_allocator_t* allocator, size_t size, size_t alignment)
+{
+    if (alignment <= 1)
+    {
+        return thread_cache_allocate(allocator, size);
+    }
+
+    return thread_cache_allocate_uncached(allocator, thread_cache_get(allocator), size, alignment);
+}
+
+/**
+ * Reallocates memory with the given alignment.
+ * @param allocator A thread cache allocator
+ * @param memory A pointer, or `NULL`
+ * @param size A size in bytes
+ * @param alignment A power of two
+ * @return A pointer, or `NULL`
+ */
+static void* thread_cache_reallocate(thread_cache_allocator_t* allocator, void* memory, size_t size, size_t alignment)
+{
+    if (memory == NULL && size == 0)
+    {
+        return NULL;
+    }
+    else if (size == 0)
+    {
+        thread_cache_deallocate(allocator, memory);
+        return NULL;
+    }
+    // The memory following a header cannot be aligned beyond the size of the header.
+    else if (alignment > THREAD_CACHE_HEADER_SIZE)
+    {
+        return NULL;
+    }
+    else if (memory == NULL)
+    {
+        return thread_cache_allocate_aligned(allocator, size, alignment);
+    }
+
+    size_t old_size = *thread_cache_header(memory);
+
+    // Blocks of a size class can grow up to the size of their class.
+    if (size <= old_size && ((uintptr_t) memory & (alignment - 1)) == 0)
+    {
+        return memory;
+    }
+
+    void* new_memory = thread_cache_allocate_aligned(allocator, size, alignment);
+
+    if (new_memory == NULL)
+    {
+        return NULL;
+    }
+
+    memcpy(new_memory, memory, old_size < size ? old_size : size);
+    thread_cache_deallocate(allocator, memory);
+
+    return new_memory;
+}
+
+static void* thread_cache_allocator_reallocate(allocator_t* _allocator, void* memory, size_t size)
+{
+    thread_cache_allocator_t* allocator = FIELD_PARENT_PTR(thread_cache_allocator_t, allocator, _allocator);
+
+    return thread_cache_reallocate(allocator, memory, size, 1);
+}
+
+static void* thread_cache_allocator_reallocate_aligned(allocator_t* _allocator, void* memory, size_t size, size_t alignment)
+{
+    thread_cache_allocator_t* allocator = FIELD_PARENT_PTR(thread_cache_allocator_t, allocator, _allocator);
+
+    return thread_cache_reallocate(allocator, memory, size, alignment);
+}
+
+static const allocator_t thread_cache_allocator_vtable = {
+    thread_cache_allocator_reallocate,
+    thread_cache_allocator_reallocate_aligned,
+    NULL,
+    NULL,
+    NULL,
+};
+
+bool thread_cache_allocator_init(thread_cache_allocator_t* allocator, allocator_t* parent)
+{
+    allocator->allocator = thread_cache_allocator_vtable;
+    allocator->parent = parent;
+    memset(&allocator->stats, 0, sizeof(thread_cache_stats_t));
+
+    if (mtx_init(&allocator->lock, mtx_plain) != thrd_success)
+    {
+        return false;
+    }
+
+    if (tss_create(&allocator->caches, thread_cache_destroy) != thrd_success)
+    {
+        mtx_destroy(&allocator->lock);
+        return false;
+    }
+
+    return true;
+}
+
+void thread_cache_allocator_deinit(thread_cache_allocator_t* allocator)
+{
+    thread_cache_t* cache = (thread_cache_t*) tss_get(allocator->caches);
+
+    if (cache != NULL)
+    {
+        thread_cache_destroy(cache);
+        tss_set(allocator->caches, NULL);
+    }
+
+    tss_delete(allocator->caches);
+    mtx_destroy(&allocator->lock);
+}
+
+void thread_cache_allocator_flush(thread_cache_allocator_t* allocator)
+{
+    thread_cache_t* cache = (thread_cache_t*) tss_get(allocator->caches);
+
+    if (cache == NULL)
+    {
+        return;
+    }
+
+    mtx_lock(&allocator->lock);
+    thread_cache_release_all(cache);
+    mtx_unlock(&allocator->lock);
+}
+
+thread_cache_stats_t thread_cache_allocator_stats(thread_cache_allocator_t* allocator)
+{
+    mtx_lock(&allocator->lock);
+    thread_cache_stats_t stats = allocator->stats;
+    mtx_unlock(&allocator->lock);
+
+    thread_cache_t* cache = (thread_cache_t*) tss_get(allocator->caches);
+
+    if (cache != NULL)
+    {
+        thread_cache_stats_add(&stats, &cache->stats);
+    }
+
+    return stats;
+}
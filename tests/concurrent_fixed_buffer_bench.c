@@ -0,0 +1,293 @@
+#include "allocators/concurrent_fixed_buffer_allocator.h"
+#include "allocators/fixed_buffer_allocator.h"
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <threads.h>
+#include <time.h>
+
+/**
+ * The size of the buffer shared by all threads.
+ */
+#define BUFFER_SIZE ((size_t) 1 << 24)
+
+/**
+ * The number of shards of the concurrent allocator.
+ */
+#define SHARD_COUNT 8
+
+/**
+ * The number of blocks every worker holds at most.
+ */
+#define HELD_COUNT 64
+
+/**
+ * The largest number of threads.
+ */
+#define MAX_THREADS 8
+
+/**
+ * A block, tagged with the worker allocating it.
+ */
+typedef struct {
+    size_t owner;
+    size_t size;
+} block_t;
+
+static concurrent_fixed_buffer_allocator_t concurrent;
+static fixed_buffer_allocator_t single;
+static mtx_t single_lock;
+static bool use_single;
+static int thread_count;
+static long operations = 200000;
+static _Atomic(block_t*) mailboxes[MAX_THREADS];
+static atomic_size_t failures;
+static atomic_size_t corruptions;
+
+/**
+ * Allocates a block from the allocator under test.
+ * @param size A size in bytes
+ * @return A block, or `NULL`
+ */
+static void* get(size_t size)
+{
+    if (!use_single)
+    {
+        return allocate(&concurrent.allocator, size);
+    }
+
+    mtx_lock(&single_lock);
+    void* memory = allocate(&single.allocator, size);
+    mtx_unlock(&single_lock);
+
+    return memory;
+}
+
+/**
+ * Frees a block to the allocator under test.
+ * @param memory A block
+ */
+static void put(void* memory)
+{
+    if (!use_single)
+    {
+        deallocate(&concurrent.allocator, memory);
+        return;
+    }
+
+    mtx_lock(&single_lock);
+    deallocate(&single.allocator, memory);
+    mtx_unlock(&single_lock);
+}
+
+/**
+ * Checks the tag of a block.
+ * @param block A block
+ * @param owner The worker which allocated it
+ */
+static void check(block_t* block, size_t owner)
+{
+    if (block->owner != owner || ((unsigned char*) block)[block->size - 1] != (unsigned char) owner)
+    {
+        atomic_fetch_add(&corruptions, 1);
+    }
+}
+
+/**
+ * Allocates and frees blocks of random sizes, handing a quarter of them to the next worker, which frees them, so that
+ * some blocks are freed by a thread whose home shard does not own them.
+ * @param data The identifier of the worker
+ * @return 0
+ */
+static int worker(void* data)
+{
+    size_t id = (size_t) data;
+    size_t next = (id + 1) % (size_t) thread_count;
+    size_t previous = (id + (size_t) thread_count - 1) % (size_t) thread_count;
+    block_t* held[HELD_COUNT] = { NULL };
+    uint32_t seed = (uint32_t) id * 2654435761u + 1;
+
+    for (long i = 0; i < operations; ++i)
+    {
+        seed = seed * 1103515245u + 12345u;
+        size_t k = (seed >> 8) % HELD_COUNT;
+
+        if (held[k] == NULL)
+        {
+            size_t size = sizeof(block_t) + 1 + (seed >> 16) % 512;
+
+            if ((held[k] = get(size)) == NULL)
+            {
+                atomic_fetch_add(&failures, 1);
+                continue;
+            }
+
+            memset(held[k], (unsigned char) id, size);
+            held[k]->owner = id;
+            held[k]->size = size;
+        }
+        else if ((seed >> 4) % 4 == 0)
+        {
+            check(held[k], id);
+            block_t* other = atomic_exchange(&mailboxes[next], held[k]);
+            held[k] = NULL;
+
+            if (other != NULL)
+            {
+                check(other, id);
+                put(other);
+            }
+        }
+        else
+        {
+            check(held[k], id);
+            put(held[k]);
+            held[k] = NULL;
+        }
+
+        block_t* handed = atomic_exchange(&mailboxes[id], NULL);
+
+        if (handed != NULL)
+        {
+            check(handed, previous);
+            put(handed);
+        }
+    }
+
+    for (size_t k = 0; k < HELD_COUNT; ++k)
+    {
+        if (held[k] != NULL)
+        {
+            put(held[k]);
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Runs workers on the allocator under test.
+ * @return The elapsed time in seconds
+ */
+static double run(void)
+{
+    thrd_t threads[MAX_THREADS];
+    struct timespec begin, end;
+
+    timespec_get(&begin, TIME_UTC);
+
+    for (int i = 0; i < thread_count; ++i)
+    {
+        thrd_create(&threads[i], worker, (void*) (size_t) i);
+    }
+
+    for (int i = 0; i < thread_count; ++i)
+    {
+        thrd_join(threads[i], NULL);
+    }
+
+    timespec_get(&end, TIME_UTC);
+
+    // Blocks still in mailboxes were last handed by a worker which has exited.
+    for (int i = 0; i < thread_count; ++i)
+    {
+        block_t* handed = atomic_exchange(&mailboxes[i], NULL);
+
+        if (handed != NULL)
+        {
+            put(handed);
+        }
+    }
+
+    return (double) (end.tv_sec - begin.tv_sec) + (double) (end.tv_nsec - begin.tv_nsec) / 1e9;
+}
+
+/**
+ * Checks that a heap is left with a single hole, every block having been freed.
+ * @param heap A fixed buffer allocator
+ * @return If the heap is empty
+ */
+static bool is_empty(fixed_buffer_allocator_t* heap)
+{
+    fixed_buffer_node_t* node = fixed_buffer_node_first(heap);
+
+    return fixed_buffer_node_is_hole(heap, node) && fixed_buffer_node_next(heap, node) == NULL;
+}
+
+/**
+ * Measures how a concurrent fixed buffer allocator scales with the number of threads allocating from it and freeing to
+ * it, compared with a single fixed buffer allocator behind a mutex.
+ *
+ * Usage: concurrent_fixed_buffer_bench [operations per thread]
+ */
+int main(int argc, char** argv)
+{
+    char* buffer = malloc(BUFFER_SIZE);
+
+    if (buffer == NULL)
+    {
+        return EXIT_FAILURE;
+    }
+
+    if (argc > 1)
+    {
+        operations = strtol(argv[1], NULL, 10);
+    }
+
+    mtx_init(&single_lock, mtx_plain);
+
+    for (thread_count = 1; thread_count <= MAX_THREADS; thread_count *= 2)
+    {
+        concurrent = concurrent_fixed_buffer_allocator_init(FBS_TLSF, SHARD_COUNT, buffer, BUFFER_SIZE);
+        use_single = false;
+        double concurrent_time = run();
+
+        // Draining the queues of remote frees must leave every shard empty.
+        concurrent_fixed_buffer_shard_t* shards = concurrent.shards;
+        size_t shard_count = concurrent.shard_count;
+        concurrent_fixed_buffer_allocator_deinit(&concurrent);
+
+        for (size_t i = 0; i < shard_count; ++i)
+        {
+            if (!is_empty(&shards[i].heap))
+            {
+                fprintf(stderr, "shard %zu is not empty\n", i);
+                return EXIT_FAILURE;
+            }
+        }
+
+        single = fixed_buffer_allocator_init(FBS_TLSF, buffer, BUFFER_SIZE);
+        use_single = true;
+        double single_time = run();
+
+        if (!is_empty(&single))
+        {
+            fprintf(stderr, "the single heap is not empty\n");
+            return EXIT_FAILURE;
+        }
+
+        double count = (double) thread_count * (double) operations;
+
+        printf(
+            "%d threads: %d shards %.1f ns/op, single lock %.1f ns/op\n",
+            thread_count,
+            SHARD_COUNT,
+            concurrent_time / count * 1e9,
+            single_time / count * 1e9
+        );
+    }
+
+    mtx_destroy(&single_lock);
+    free(buffer);
+
+    if (atomic_load(&failures) != 0 || atomic_load(&corruptions) != 0)
+    {
+        fprintf(stderr, "%zu failed allocations, %zu corrupted blocks\n", atomic_load(&failures), atomic_load(&corruptions));
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,209 @@
+#include "allocators/c_allocator.h"
+#include "allocators/lockfree_pool_allocator.h"
+#include "allocators/pool_allocator.h"
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <threads.h>
+#include <time.h>
+
+/**
+ * The size of the blocks, which workers fill and tag with their identifier.
+ */
+#define BLOCK_SIZE 48
+
+/**
+ * The number of blocks of the pools, few enough for threads to contend on them.
+ */
+#define BLOCK_COUNT 256
+
+/**
+ * The number of blocks every worker holds at most.
+ */
+#define HELD_COUNT 16
+
+/**
+ * The largest number of threads.
+ */
+#define MAX_THREADS 8
+
+static lockfree_pool_allocator_t lockfree_pool;
+static pool_allocator_t pool;
+static mtx_t pool_lock;
+static bool use_lock;
+static long operations = 1000000;
+static atomic_size_t failures;
+static atomic_size_t corruptions;
+
+/**
+ * Allocates a block from the pool under test.
+ * @return A block, or `NULL`
+ */
+static void* get(void)
+{
+    if (!use_lock)
+    {
+        return allocate(&lockfree_pool.allocator, BLOCK_SIZE);
+    }
+
+    mtx_lock(&pool_lock);
+    void* memory = allocate(&pool.allocator, BLOCK_SIZE);
+    mtx_unlock(&pool_lock);
+
+    return memory;
+}
+
+/**
+ * Frees a block to the pool under test.
+ * @param memory A block
+ */
+static void put(void* memory)
+{
+    if (!use_lock)
+    {
+        deallocate(&lockfree_pool.allocator, memory);
+        return;
+    }
+
+    mtx_lock(&pool_lock);
+    deallocate(&pool.allocator, memory);
+    mtx_unlock(&pool_lock);
+}
+
+/**
+ * Allocates and frees blocks in turn, checking that no other thread wrote to the blocks it holds.
+ * @param data The identifier of the worker
+ * @return 0
+ */
+static int worker(void* data)
+{
+    size_t id = (size_t) data;
+    size_t* held[HELD_COUNT] = { NULL };
+
+    for (long i = 0; i < operations; ++i)
+    {
+        size_t k = (size_t) i % HELD_COUNT;
+
+        if (held[k] != NULL)
+        {
+            if (held[k][0] != id || held[k][BLOCK_SIZE / sizeof(size_t) - 1] != id)
+            {
+                atomic_fetch_add(&corruptions, 1);
+            }
+
+            put(held[k]);
+            held[k] = NULL;
+        }
+        else if ((held[k] = get()) != NULL)
+        {
+            memset(held[k], 0, BLOCK_SIZE);
+            held[k][0] = id;
+            held[k][BLOCK_SIZE / sizeof(size_t) - 1] = id;
+        }
+        else
+        {
+            atomic_fetch_add(&failures, 1);
+        }
+    }
+
+    for (size_t k = 0; k < HELD_COUNT; ++k)
+    {
+        if (held[k] != NULL)
+        {
+            put(held[k]);
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Runs workers on the pool under test.
+ * @param count The number of threads
+ * @return The elapsed time in seconds
+ */
+static double run(int count)
+{
+    thrd_t threads[MAX_THREADS];
+    struct timespec begin, end;
+
+    timespec_get(&begin, TIME_UTC);
+
+    for (int i = 0; i < count; ++i)
+    {
+        thrd_create(&threads[i], worker, (void*) (size_t) (i + 1));
+    }
+
+    for (int i = 0; i < count; ++i)
+    {
+        thrd_join(threads[i], NULL);
+    }
+
+    timespec_get(&end, TIME_UTC);
+
+    return (double) (end.tv_sec - begin.tv_sec) + (double) (end.tv_nsec - begin.tv_nsec) / 1e9;
+}
+
+/**
+ * Stresses the lock-free pool allocator from several threads and compares its throughput with a pool allocator behind
+ * a mutex.
+ *
+ * Usage: lockfree_pool_stress [operations per thread]
+ */
+int main(int argc, char** argv)
+{
+    static _Alignas(64) char buffer[BLOCK_SIZE * BLOCK_COUNT];
+
+    if (argc > 1)
+    {
+        operations = strtol(argv[1], NULL, 10);
+    }
+
+    pool = pool_allocator_init(c_allocator, BLOCK_SIZE, BLOCK_COUNT);
+    mtx_init(&pool_lock, mtx_plain);
+
+    for (int count = 1; count <= MAX_THREADS; count *= 2)
+    {
+        lockfree_pool = lockfree_pool_allocator_init(buffer, sizeof(buffer), BLOCK_SIZE);
+
+        use_lock = false;
+        double lockfree_time = run(count);
+
+        // Every block must have come back to the free list exactly once.
+        size_t free_count = 0;
+
+        while (allocate(&lockfree_pool.allocator, BLOCK_SIZE) != NULL)
+        {
+            ++free_count;
+        }
+
+        if (free_count != BLOCK_COUNT)
+        {
+            fprintf(stderr, "%zu free blocks instead of %d\n", free_count, BLOCK_COUNT);
+            return EXIT_FAILURE;
+        }
+
+        use_lock = true;
+        double mutex_time = run(count);
+
+        printf(
+            "%d threads: lock-free %.1f Mops/s, mutex pool %.1f Mops/s\n",
+            count,
+            (double) count * (double) operations / lockfree_time / 1e6,
+            (double) count * (double) operations / mutex_time / 1e6
+        );
+    }
+
+    pool_allocator_deinit(&pool);
+    mtx_destroy(&pool_lock);
+
+    if (atomic_load(&failures) != 0 || atomic_load(&corruptions) != 0)
+    {
+        fprintf(stderr, "%zu failed allocations, %zu corrupted blocks\n", atomic_load(&failures), atomic_load(&corruptions));
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}